@@ -0,0 +1,157 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// the checkpoint log of --checkpoint and --resume
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <unistd.h>
+#include "checkpoint.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::cerr;
+using std::endl;
+
+static const char MAGIC[] = "SREACHC1";
+
+static bool get (std::FILE * f, void * data, size_t size) {
+    return std::fread(data, size, 1, f) == 1;
+}
+
+Checkpoint::Checkpoint (string const & name, bool r, double s)
+    : file(name), resume(r), reading(r), seconds(s), f(NULL), logged(0), columns(0), good(0),
+      last(std::chrono::steady_clock::now()) {
+
+    if (!resume) return;
+
+    f = std::fopen(file.c_str(), "rb+");
+    if (f == NULL) fail("cannot open the checkpoint to resume", file);
+
+    char magic[8];
+    uint32_t length, cols;
+    uint64_t seed;
+    if (!get(f, magic, 8) || memcmp(magic, MAGIC, 8) != 0 || !get(f, &length, 4)) {
+        fail("not a checkpoint", file);
+    }
+    run.resize(length);
+    if ((length > 0 && !get(f, &run[0], length)) || !get(f, &seed, 8) || !get(f, &cols, 4)) {
+        fail("not a checkpoint", file);
+    }
+    logged = seed;
+    columns = cols;
+    good = std::ftell(f);
+}
+
+Checkpoint::~Checkpoint () {
+    if (f != NULL) {
+        flush();
+        std::fclose(f);
+    }
+}
+
+void Checkpoint::begin (string const & r, unsigned long seed, unsigned long cols) {
+
+    if (resume) {
+        if (r != run || cols != columns) {
+            fail("the checkpoint is of another run: " + file + "\n  it was: " + run + "\n  this is: " + r);
+        }
+        if (seed != logged) fail("the checkpoint was taken with another seed", std::to_string(logged));
+        return;
+    }
+
+    run = r;
+    logged = seed;
+    columns = cols;
+    f = std::fopen(file.c_str(), "wb");
+    if (f == NULL) fail("cannot write the checkpoint", file);
+    uint32_t length = run.size();
+    uint64_t s = seed;
+    uint32_t c = columns;
+    buffer.append(MAGIC, 8);
+    buffer.append(reinterpret_cast<char const *>(&length), 4);
+    buffer.append(run);
+    buffer.append(reinterpret_cast<char const *>(&s), 8);
+    buffer.append(reinterpret_cast<char const *>(&c), 4);
+    flush();
+}
+
+bool Checkpoint::next (Record & r) {
+    if (!reading) return false;
+
+    uint8_t flags;
+    uint32_t timeouts;
+    r.assignment.resize(columns);
+    if (get(f, &flags, 1) && get(f, &timeouts, 4) && get(f, &r.weight, 8)
+        && (columns == 0 || get(f, &r.assignment[0], columns * sizeof(double)))) {
+        r.sat = flags & 1;
+        r.guessed = flags & 2;
+        r.timeouts = timeouts;
+        good = std::ftell(f);
+        return true;
+    }
+
+    // a record cut short when the run was stopped is dropped,
+    // and the log goes on after the last whole one
+    std::fflush(f);
+    if (ftruncate(fileno(f), good) != 0) fail("cannot truncate the checkpoint", strerror(errno));
+    std::fseek(f, good, SEEK_SET);
+    reading = false;
+    return false;
+}
+
+void Checkpoint::add (Record const & r) {
+    uint8_t flags = (r.sat ? 1 : 0) | (r.guessed ? 2 : 0);
+    uint32_t timeouts = r.timeouts;
+    buffer.append(reinterpret_cast<char const *>(&flags), 1);
+    buffer.append(reinterpret_cast<char const *>(&timeouts), 4);
+    buffer.append(reinterpret_cast<char const *>(&r.weight), 8);
+    buffer.append(reinterpret_cast<char const *>(r.assignment.data()), columns * sizeof(double));
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - last).count() >= seconds) flush();
+}
+
+void Checkpoint::flush () {
+    last = std::chrono::steady_clock::now();
+    if (buffer.empty()) return;
+    if (std::fwrite(buffer.data(), buffer.size(), 1, f) != 1 || std::fflush(f) != 0) {
+        fail("cannot write the checkpoint", strerror(errno));
+    }
+    // on disk before the run goes on, so that a reboot keeps it
+    fsync(fileno(f));
+    buffer.clear();
+}
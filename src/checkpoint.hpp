@@ -0,0 +1,94 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <chrono>
+
+// an append-only log of the samples of a run, in sample order, from which
+// an interrupted run is resumed: the tests, the counters and the cache are
+// all worked out again from the samples, and the random number stream of
+// every later sample only depends on its index
+// the file is "SREACHC1", a uint32 length and the text naming the run, the
+// uint64 seed and the uint32 number of random variables, then one record
+// per sample; the records are written in blocks, every given seconds
+class Checkpoint {
+public:
+    struct Record {
+        bool sat;
+        bool guessed;                   // the verdict of the straggler policy
+        unsigned long timeouts;
+        double weight;
+        std::vector<double> assignment;
+    };
+
+    // resume the run logged in the file, or start a new log there
+    Checkpoint (std::string const & file, bool resume, double seconds);
+    ~Checkpoint ();
+
+    bool resumed () const {
+        return resume;
+    }
+
+    // the seed of the resumed run
+    unsigned long seed () const {
+        return logged;
+    }
+
+    // check that the resumed run is this one, or start the log of this one
+    void begin (std::string const & run, unsigned long seed, unsigned long columns);
+
+    // the next sample of the resumed run, false after the last one;
+    // the logging goes on after it
+    bool next (Record & r);
+
+    void add (Record const & r);
+
+    // write out the records added so far
+    void flush ();
+
+private:
+    std::string file;
+    bool resume;
+    bool reading;                       // the records of the resumed run are not all read
+    double seconds;
+    std::FILE * f;
+    std::string run;                    // as logged
+    unsigned long logged;               // the seed logged
+    unsigned long columns;
+    long good;                          // end of the last whole record read
+    std::string buffer;
+    std::chrono::steady_clock::time_point last;  // the last flush
+
+    Checkpoint (Checkpoint const &);
+    Checkpoint & operator= (Checkpoint const &);
+};
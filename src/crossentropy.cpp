@@ -0,0 +1,163 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "crossentropy.hpp"
+
+using std::string;
+using std::vector;
+using std::ostringstream;
+
+// the coarsenings of the precision at most
+static const unsigned RELAXATIONS = 3;
+
+// elites an iteration needs to fit to, below the coarsest precision
+static const unsigned long ELITES = 10;
+
+// the fraction of the samples sat at the precision asked for that ends the fit
+static const double RHO = 0.1;
+
+// the weight of a new fit against the last proposals
+static const double SMOOTHING = 0.7;
+
+// the least sigma of a normal proposal, against that of the declared distribution
+static const double NARROWEST = 0.01;
+
+CrossEntropy::CrossEntropy (RVProgram const & rvp, double precision)
+    : rvprog(rvp), target(precision), proposals(rvp.count(), NULL), sat(0), relaxed(0), reached(false) {
+
+    for (unsigned long i = 0; i < rvprog.size(); ++i) {
+        int v = rvprog.find(rvprog.name(i));
+        RandomVar const & var = rvprog.var(v);
+        if (var.jump) continue;
+        bool constant = true;
+        for (unsigned long k = 0; k < var.params.size(); ++k) constant = constant && var.params[k].constant();
+        if (!constant) continue;
+
+        // the first fit is smoothed with the moments of the declared distribution
+        Proposal p;
+        p.b = 0;
+        switch (var.kind) {
+            case RandomVar::UNIFORM:
+                p.kind = RandomVar::NORMAL;
+                p.a = (var.params[0].value + var.params[1].value) / 2;
+                p.b = (var.params[1].value - var.params[0].value) / sqrt(12.0);
+                break;
+            case RandomVar::NORMAL:
+                p.kind = RandomVar::NORMAL;
+                p.a = var.params[0].value;
+                p.b = var.params[1].value;
+                break;
+            case RandomVar::EXPONENTIAL:
+                p.kind = RandomVar::EXPONENTIAL;
+                p.a = var.params[0].value;
+                break;
+            default:
+                continue;
+        }
+        slots.push_back(i);
+        vars.push_back(v);
+        fitted.push_back(p);
+        least.push_back(p.b * NARROWEST);
+    }
+    sw.assign(vars.size(), 0);
+    swx.assign(vars.size(), 0);
+    swx2.assign(vars.size(), 0);
+    delta = RVProgram::format(target);
+}
+
+void CrossEntropy::elite (vector<double> const & assignment, double weight) {
+    for (unsigned long j = 0; j < vars.size(); ++j) {
+        double x = assignment[slots[j]];
+        sw[j] += weight;
+        swx[j] += weight * x;
+        swx2[j] += weight * x * x;
+    }
+    sat++;
+}
+
+void CrossEntropy::fit () {
+    for (unsigned long j = 0; j < vars.size(); ++j) {
+        if (!(sw[j] > 0)) continue;
+        Proposal & p = fitted[j];
+        double mean = swx[j] / sw[j];
+        if (p.kind == RandomVar::NORMAL) {
+            double sigma = sqrt(std::max(swx2[j] / sw[j] - mean * mean, 0.0));
+            p.a = SMOOTHING * mean + (1 - SMOOTHING) * p.a;
+            p.b = std::max(SMOOTHING * sigma + (1 - SMOOTHING) * p.b, least[j]);
+        } else if (mean > 0) {
+            p.a = SMOOTHING / mean + (1 - SMOOTHING) * p.a;
+        }
+        proposals[vars[j]] = &fitted[j];
+    }
+}
+
+bool CrossEntropy::next (unsigned long n) {
+
+    bool more = true;
+    reached = false;
+    if (sat >= ELITES || (relaxed == RELAXATIONS && sat > 0)) fit();
+    if (sat < ELITES) {
+        // too rare yet: relax the goal, or give up at the coarsest precision
+        if (relaxed < RELAXATIONS) relaxed++;
+        else more = (sat > 0);
+    } else if (relaxed > 0) {
+        relaxed--;
+    } else if (sat >= RHO * n) {
+        reached = true;
+        more = false;
+    }
+
+    sw.assign(vars.size(), 0);
+    swx.assign(vars.size(), 0);
+    swx2.assign(vars.size(), 0);
+    sat = 0;
+    delta = RVProgram::format(target * pow(10.0, relaxed));
+    return more;
+}
+
+string CrossEntropy::spec () const {
+    ostringstream text;
+    for (unsigned long j = 0; j < vars.size(); ++j) {
+        if (proposals[vars[j]] == NULL) continue;
+        Proposal const & p = fitted[j];
+        if (text.tellp() > 0) text << ";";
+        text << rvprog.var(vars[j]).name << ":";
+        if (p.kind == RandomVar::NORMAL) text << "N(" << RVProgram::format(p.a) << "," << RVProgram::format(p.b) << ")";
+        else text << "E(" << RVProgram::format(p.a) << ")";
+    }
+    return text.str();
+}
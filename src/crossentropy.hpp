@@ -0,0 +1,104 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include "rvprog.hpp"
+
+// the cross-entropy method for the proposals of importance sampling of a
+// rare goal (Rubinstein and Kroese. The Cross-Entropy Method. 2004)
+// every iteration draws samples from the current proposals, and the next
+// proposals are the maximum likelihood fit to the samples found sat (the
+// elites), each weighed with its likelihood ratio to the declared
+// distributions, and smoothed with the last proposals
+// while too few samples are sat at the precision asked for, they are
+// checked at one 10 times coarser, up to 3 times: the
+// delta-weakening of the goal is a relaxation of it, so the proposals
+// first move towards the samples near the goal, then towards the goal itself
+// the uniform and normal random variables get normal proposals, which
+// cover the whole range of a uniform one, and the exponential ones
+// exponential proposals; those whose parameters are not constant, and
+// the jump ones, keep their distributions
+class CrossEntropy {
+private:
+    RVProgram const & rvprog;
+    double target;                      // the precision asked for
+    std::vector<int> slots;             // per fitted random variable, its index in an assignment,
+    std::vector<int> vars;              // and among all the random variables
+    std::vector<Proposal> fitted;       // its current proposal
+    std::vector<double> least;          // the least sigma of a normal proposal
+    std::vector<Proposal const *> proposals;    // per random variable, NULL before the first fit
+    std::vector<double> sw, swx, swx2;  // the sums of the ratios of the elites, times x and x^2
+    unsigned long sat;                  // elites of the iteration
+    unsigned relaxed;                   // coarsenings of the precision
+    bool reached;
+    std::string delta;
+
+    void fit ();
+
+public:
+    CrossEntropy (RVProgram const & rvprog, double precision);
+
+    // the random variables fitted
+    unsigned long size () const {
+        return vars.size();
+    }
+
+    // the proposals to draw the samples of the iteration from
+    std::vector<Proposal const *> const & current () const {
+        return proposals;
+    }
+
+    // the precision to check them at
+    std::string const & precision () const {
+        return delta;
+    }
+
+    // a sample of the iteration found sat, with its likelihood ratio
+    void elite (std::vector<double> const & assignment, double weight);
+
+    unsigned long elites () const {
+        return sat;
+    }
+
+    // end the iteration of n samples: fit the proposals to its elites when
+    // there are enough, and choose the precision of the next; false once
+    // another iteration is of no use
+    bool next (unsigned long n);
+
+    // the last iteration had a tenth of its samples sat at the precision asked for
+    bool converged () const {
+        return reached;
+    }
+
+    // the current proposals in the form of --proposal, empty before the first fit
+    std::string spec () const;
+};
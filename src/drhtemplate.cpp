@@ -0,0 +1,188 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// split the drh model into the text around the random variables once,
+// matching whole identifiers only, so that "K" does not match inside "K2"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include "drhtemplate.hpp"
+#include "pdrh.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::ifstream;
+using std::ofstream;
+using std::ostringstream;
+using std::cout;
+using std::endl;
+
+ModelTemplate::ModelTemplate (PdrhModel const & model, RVProgram const & rvprog) : length(0) {
+    split(model.drh(), rvprog);
+}
+
+ModelTemplate::ModelTemplate (string const & drhfile, RVProgram const & rvprog) : length(0) {
+
+    ifstream drh (drhfile);
+    if (!drh.is_open()) {
+        fail("cannot open the drh model file");
+    }
+    ostringstream contents;
+    contents << drh.rdbuf();
+    drh.close();
+    split(contents.str(), rvprog);
+}
+
+void ModelTemplate::split (string const & text, RVProgram const & rvprog) {
+
+    map<string, int> names;
+    for (unsigned long i = 0; i < rvprog.size(); ++i) {
+        names[rvprog.name(i)] = i;
+        this->names.push_back(rvprog.name(i));
+    }
+
+    string chunk;
+    unsigned long i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (isdigit(c) || c == '.') {
+            // a number literal, whose exponent must not be read as a name
+            unsigned long j = i;
+            while (j < text.size() && (isdigit(text[j]) || text[j] == '.')) j++;
+            if (j < text.size() && (text[j] == 'e' || text[j] == 'E')) {
+                unsigned long k = j + 1;
+                if (k < text.size() && (text[k] == '+' || text[k] == '-')) k++;
+                if (k < text.size() && isdigit(text[k])) {
+                    j = k;
+                    while (j < text.size() && isdigit(text[j])) j++;
+                }
+            }
+            chunk.append(text, i, j - i);
+            i = j;
+        } else if (isalpha(c) || c == '_') {
+            unsigned long j = i;
+            while (j < text.size() && (isalnum(text[j]) || text[j] == '_')) j++;
+            map<string, int>::const_iterator it = names.find(text.substr(i, j - i));
+            if (it == names.end()) {
+                chunk.append(text, i, j - i);
+            } else {
+                length += chunk.size();
+                chunks.push_back(chunk);
+                slots.push_back(it->second);
+                chunk.clear();
+            }
+            i = j;
+        } else {
+            chunk += c;
+            i++;
+        }
+    }
+    length += chunk.size();
+    chunks.push_back(chunk);
+}
+
+void ModelTemplate::instantiate (vector<double> const & assignment, string & buf) const {
+
+    // format every value once, however often it occurs
+    vector<string> values(assignment.size());
+    for (unsigned long v = 0; v < assignment.size(); ++v) {
+        values[v] = RVProgram::format(assignment[v]);
+    }
+
+    buf.clear();
+    buf.reserve(length + 16 * slots.size());
+    for (unsigned long s = 0; s < slots.size(); ++s) {
+        buf += chunks[s];
+        buf += values[slots[s]];
+    }
+    buf += chunks.back();
+}
+
+void ModelTemplate::instantiate_box (vector<double> const & lo, vector<double> const & hi, string & buf) const {
+
+    // the interval parameters are declared as variables ahead of the modes
+    vector<string> values(lo.size());
+    string declarations, flows;
+    char text[64];
+    for (unsigned long v = 0; v < lo.size(); ++v) {
+        if (lo[v] == hi[v]) {
+            values[v] = RVProgram::format(lo[v]);
+            continue;
+        }
+        snprintf(text, sizeof(text), "[%.17g, %.17g] ", lo[v], hi[v]);
+        declarations += text + names[v] + ";\n";
+        flows += "\n        d/dt[" + names[v] + "] = 0;";
+        values[v] = names[v];
+    }
+
+    string body;
+    body.reserve(length + 16 * slots.size());
+    for (unsigned long s = 0; s < slots.size(); ++s) {
+        body += chunks[s];
+        body += values[slots[s]];
+    }
+    body += chunks.back();
+
+    buf = declarations;
+    buf.reserve(declarations.size() + body.size() + 8 * flows.size());
+    unsigned long from = 0, at;
+    while ((at = body.find("flow:", from)) != string::npos) {
+        buf.append(body, from, at + 5 - from);
+        buf += flows;
+        from = at + 5;
+    }
+    buf.append(body, from, string::npos);
+}
+
+void ModelTemplate::write (vector<double> const & assignment, string const & numodelfile, string & buf) const {
+
+    instantiate(assignment, buf);
+    save(buf, numodelfile);
+}
+
+void ModelTemplate::save (string const & buf, string const & numodelfile) {
+
+    ofstream nudrhfile (numodelfile, std::ios::binary);
+    if (!nudrhfile.is_open()) {
+        fail("cannot write the drh model file: " + numodelfile);
+    }
+    nudrhfile.write(buf.data(), buf.size());
+    nudrhfile.close();
+}
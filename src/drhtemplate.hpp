@@ -0,0 +1,69 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include "rvprog.hpp"
+
+class PdrhModel;
+
+// the drh model parsed once into literal chunks and slots, one slot per
+// occurrence of a random variable; a sample is instantiated by a single
+// concatenation instead of rewriting the model text
+class ModelTemplate {
+private:
+    std::vector<std::string> chunks;    // chunks[i] precedes slots[i], the last chunk ends the model
+    std::vector<int> slots;             // the random variable of each occurrence
+    unsigned long length;               // total length of the chunks
+    std::vector<std::string> names;     // of the random variables
+
+    void split (std::string const & text, RVProgram const & rvprog);
+
+public:
+    // the drh model of a pdrh model, as read into memory
+    ModelTemplate (PdrhModel const & model, RVProgram const & rvprog);
+
+    // read a drh model, such as the one written by pdrh2drh()
+    ModelTemplate (std::string const & drhfile, RVProgram const & rvprog);
+
+    // the model with the sampled values in place of the random variables
+    void instantiate (std::vector<double> const & assignment, std::string & buf) const;
+
+    // the model with each random variable i a parameter ranging over
+    // [lo[i], hi[i]] (kept constant by its flows), or a value if lo[i] == hi[i]
+    void instantiate_box (std::vector<double> const & lo, std::vector<double> const & hi, std::string & buf) const;
+
+    // instantiate the model into buf and write it to the file numodelfile
+    void write (std::vector<double> const & assignment, std::string const & numodelfile, std::string & buf) const;
+
+    // write an instantiated model to the file numodelfile
+    static void save (std::string const & buf, std::string const & numodelfile);
+};
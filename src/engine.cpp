@@ -0,0 +1,988 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// the run of sreach_para and sreach_sq as a library: the workers pull
+// sample indices from the work queue, check the sampled models with dReach
+// and push their outcomes to the completion queue; the aggregator feeds the
+// outcomes to the tests in sample order, so that the tests see the same
+// stream as a sequential run whatever the solve times
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <exception>
+#include <cstdlib>
+#include <omp.h>
+#include "engine.hpp"
+#include "options.hpp"
+#include "pdrh.hpp"
+#include "drhtemplate.hpp"
+#include "rng.hpp"
+#include "rvprog.hpp"
+#include "sampler.hpp"
+#include "solver.hpp"
+#include "straggler.hpp"
+#include "remote.hpp"
+#include "scheduler.hpp"
+#include "prefetch.hpp"
+#include "samplecache.hpp"
+#include "regioncache.hpp"
+#include "crossentropy.hpp"
+#include "samplewriter.hpp"
+#include "checkpoint.hpp"
+#include "resources.hpp"
+#include "throttle.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::endl;
+using std::cerr;
+using std::istringstream;
+using std::ostringstream;
+using std::ofstream;
+using std::vector;
+using std::max;
+
+namespace sreach {
+
+// the samples of the cross-entropy iterations take the streams from here on,
+// apart from those of the sample indices
+static const unsigned long PILOT = 1UL << 63;
+
+// the first error thrown in a thread of a run, thrown again by run once
+// every thread is over
+class Failure {
+private:
+    std::mutex lock;
+    std::exception_ptr first;
+    std::atomic<bool> set;
+
+public:
+    Failure () : set(false) {
+    }
+
+    // in the handler of the error
+    void record () {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!first) first = std::current_exception();
+        set.store(true);
+    }
+
+    bool happened () const {
+        return set.load();
+    }
+
+    void rethrow () {
+        if (first) std::rethrow_exception(first);
+    }
+};
+
+// the dReach launcher of a local worker: its own, or one borrowed from
+// the pool shared with other engines for each run, given the unfolding
+// steps and the precision of this engine
+class Launcher {
+private:
+    std::unique_ptr<Solver> own;
+    SolverPool * pool;
+    unsigned long job;
+    int k;
+    string precision;
+    std::atomic<bool> stopped;
+    std::mutex lock;
+    Solver * current;                   // the one borrowed for the run going on,
+    unsigned long ticket;               // and the number of that run on it
+    std::atomic<unsigned long> rss;
+
+    template <typename Run>
+    int borrowed (Run run) {
+        Solver * solver = pool->acquire(job, stopped);
+        if (solver == NULL) return Solver::CANCELLED;
+        {
+            // cancel() interrupts it from here on, before it starts as well:
+            // no other run is asked of the launcher while it is borrowed
+            std::lock_guard<std::mutex> guard(lock);
+            current = solver;
+            ticket = solver->issued() + 1;
+        }
+        auto giveback = [&] () {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                current = NULL;
+            }
+            rss.store(max(rss.load(), solver->latest()));
+            pool->release(job, solver);
+        };
+        int r;
+        try {
+            r = run(*solver);
+        } catch (...) {
+            giveback();
+            throw;
+        }
+        giveback();
+        // once stopped, the verdict is of no use
+        return stopped.load() ? Solver::CANCELLED : r;
+    }
+
+    Launcher (Launcher const &);
+    Launcher & operator= (Launcher const &);
+
+public:
+    explicit Launcher (Solver * solver)
+        : own(solver), pool(NULL), job(0), k(0), stopped(false), current(NULL), ticket(0), rss(0) {
+    }
+
+    Launcher (SolverPool & shared, unsigned long id, string const & kmax, string const & delta)
+        : pool(&shared), job(id), k(atoi(kmax.c_str())), precision(delta), stopped(false), current(NULL), ticket(0),
+          rss(0) {
+    }
+
+    int solve (string const & drhname, string const & delta = "", int lower = 0, int upper = -1) {
+        if (own != NULL) return own->solve(drhname, delta, lower, upper);
+        return borrowed([&] (Solver & s) {
+            return s.solve(drhname, delta.empty() ? precision : delta, lower, (upper < 0) ? k : upper);
+        });
+    }
+
+    int solve_piped (string const & text, string const & delta = "", int lower = 0, int upper = -1) {
+        if (own != NULL) return own->solve_piped(text, delta, lower, upper);
+        return borrowed([&] (Solver & s) {
+            return s.solve_piped(text, delta.empty() ? precision : delta, lower, (upper < 0) ? k : upper);
+        });
+    }
+
+    // from any thread, like Solver::cancel(); a borrowed launcher only
+    // has the run of this engine killed, and goes back to the pool
+    void cancel () {
+        if (own != NULL) {
+            own->cancel();
+            return;
+        }
+        stopped.store(true);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (current != NULL) current->interrupt(ticket);
+        }
+        pool->wake();
+    }
+
+    unsigned long peak () const {
+        return (own != NULL) ? own->peak() : rss.load();
+    }
+};
+
+// the unfolding steps of the runs: k, or the sweep <from>:<to>[:<step>]
+static vector<int> unfoldings (string const & spec) {
+    vector<long> parts;
+    istringstream fields(spec);
+    string field;
+    bool valid = true;
+    while (valid && getline(fields, field, ':')) {
+        char * end;
+        long n = strtol(field.c_str(), &end, 10);
+        valid = !field.empty() && *end == '\0' && n >= 0;
+        parts.push_back(n);
+    }
+    valid = valid && !parts.empty() && parts.size() <= 3;
+    long to = (valid && parts.size() >= 2) ? parts[1] : (valid ? parts[0] : 0);
+    long step = (valid && parts.size() == 3) ? parts[2] : 1;
+    if (!valid || step <= 0 || to < parts[0]) fail("the unfolding steps must be k or <from>:<to>[:<step>]: " + spec);
+    vector<int> ks;
+    for (long k = parts[0]; k <= to; k += step) ks.push_back(k);
+    return ks;
+}
+
+Config::Config ()
+    : unfoldings("3"), precision("0.001"), threads(0), seeded(false), seed(0), piped(false), timeout(0), memory(0),
+      policy("redraw"), sampling("mc"), strata(0), cesamples(1000), ceiterations(10), output("text"), directory("."),
+      resume(false), every(60), regions(0), batch(256), port(0), remote(0), pin("auto"), tune(true),
+      log(NULL) {
+}
+
+void take_options (Options & opts, Config & config) {
+    config.checkpoint = opts.take("checkpoint", "");
+    config.resume = opts.has("resume");
+    opts.take("resume");
+    config.every = opts.take_double("checkpoint-every", 60);
+    if (config.resume && config.checkpoint.empty()) fail("--resume needs --checkpoint=<file>");
+    config.seeded = opts.has("seed");
+    config.seed = opts.take_ulong("seed", 0);
+    string io = opts.take("io", "file");
+    if (io != "file" && io != "pipe") fail("--io must be file or pipe: " + io);
+    config.piped = (io == "pipe");
+    config.timeout = opts.take_double("timeout", 0);
+    config.memory = opts.take_ulong("memory", 0);
+    config.policy = opts.take("on-timeout", "redraw");
+    config.sampling = opts.take("sampling", "mc");
+    config.strata = opts.take_ulong("strata", 0);
+    config.proposal = opts.take("proposal", "");
+    config.cesamples = opts.take_ulong("ce-samples", 1000);
+    config.ceiterations = opts.take_ulong("ce-iterations", 10);
+    config.output = opts.take("output", "text");
+    if (config.output == "none") fail("--output must be text or binary: " + config.output);
+    config.metrics = opts.take("metrics", "");
+    config.progress = opts.take("progress", "");
+    if (opts.has("coarse")) {
+        string v = opts.take("coarse");
+        double precision = atof(config.precision.c_str());
+        double delta = v.empty() ? 100 * precision : atof(v.c_str());
+        if (!(delta > precision)) fail("--coarse expects a precision coarser than " + config.precision + ": " + v);
+        ostringstream text;
+        text << delta;
+        config.coarse = text.str();
+    }
+    if (opts.has("regions")) {
+        string v = opts.take("regions");
+        config.regions = v.empty() ? 0.5 : atof(v.c_str());
+        if (!(config.regions > 0 && config.regions <= 1)) fail("--regions expects a size in (0, 1]: " + v);
+    }
+    config.batch = opts.take_ulong("batch", 256);
+    config.pin = opts.take("pin", "auto");
+    if (config.pin != "auto" && config.pin != "none" && config.pin != "cores" && config.pin != "nodes") {
+        fail("--pin must be auto, none, cores or nodes: " + config.pin);
+    }
+    string tune = opts.take("tune", "on");
+    if (tune != "on" && tune != "off") fail("--tune must be on or off: " + tune);
+    config.tune = (tune == "on");
+    config.port = opts.take_ulong("listen", 0);
+    config.remote = opts.take_ulong("remote", config.port > 0 ? 1 : 0);
+    if ((config.port == 0) != (config.remote == 0) || config.port > 65535) {
+        fail("remote workers need both --listen=<port> and --remote=<n>");
+    }
+}
+
+Engine::Engine (Config const & c)
+    : config(c), pool(NULL), shared(NULL), master(0), workers(0), timeouts(0), guesses(0), boxes(0), concurrent(0), lowest(0), rss(0),
+      metrics(NULL), store(NULL) {
+}
+
+Engine::~Engine () {
+    for (unsigned long j = 0; j < tests.size(); ++j) delete tests[j];
+    delete metrics;
+    delete store;
+}
+
+void Engine::say (string const & line) {
+    if (config.log == NULL) return;
+    std::lock_guard<std::mutex> guard(logging);
+    *config.log << line << endl;
+}
+
+void Engine::load (string const & file) {
+    load(std::make_shared<PdrhModel const>(file), file);
+}
+
+void Engine::load (std::shared_ptr<PdrhModel const> model, string const & file) {
+    pdrh = model;
+    pdrhfile = file;
+}
+
+void Engine::share (SolverPool & launchers) {
+    pool = &launchers;
+}
+
+void Engine::share (SampleCache & verdicts) {
+    shared = &verdicts;
+}
+
+void Engine::test (string const & spec) {
+    // checked at once
+    vector<Test *> some = make_tests(spec);
+    for (unsigned long j = 0; j < some.size(); ++j) delete some[j];
+    specs.push_back(spec);
+}
+
+void Engine::read (string const & testfile) {
+    std::ifstream input(testfile.c_str());
+    if (!input.is_open()) fail("cannot open testfile: " + testfile);
+    string line;
+    while (getline(input, line)) test(line);
+}
+
+void Engine::report (std::ostream & out) const {
+    out << "Number of processors: " << omp_get_num_procs() << endl;
+    if (!limits.empty()) out << limits << endl;
+    out << "Number of threads: " << workers << endl;
+    if (lowest < unsigned(workers)) {
+        out << "dReach runs at once: " << concurrent << " at the end, " << lowest << " at the least" << endl;
+    }
+    if (rss > 0) out << "dReach peak resident set: " << (rss >> 10) << " MB" << endl;
+    if (config.remote > 0) out << "Number of remote workers: " << config.remote << endl;
+    if (timeouts > 0) out << "dReach runs over the limits: " << timeouts << endl;
+    if (guesses > 0) {
+        out << "Verdicts guessed by --on-timeout=" << config.policy
+            << (config.policy == "coarsen" ? " (delta-sat at a coarser precision)" : "") << ": " << guesses << endl;
+    }
+    if (metrics != NULL) metrics->report(out);
+    if (config.regions > 0) out << "Certified unsat boxes: " << boxes << endl;
+}
+
+vector<Result> const & Engine::run () {
+
+    results.clear();
+    if (pdrh == NULL) fail("no model loaded");
+    string const & precision = config.precision;
+    string const & dir = config.directory;
+    // a pool's own --io and limits hold for its runs
+    bool piped = (pool != NULL) ? pool->piped() : config.piped;
+    double timeout = (pool != NULL) ? pool->timeout() : config.timeout;
+    unsigned long memory = (pool != NULL) ? pool->memory() : config.memory;
+
+    std::unique_ptr<Checkpoint> checkpoint(config.checkpoint.empty() ? NULL
+                                           : new Checkpoint(config.checkpoint, config.resume, config.every));
+    if (config.seeded) {
+        master = config.seed;
+    } else if (config.resume) {
+        master = checkpoint->seed();
+    } else {
+        std::random_device rd;
+        master = (static_cast<unsigned long>(rd()) << 32) | rd();
+    }
+    Straggler straggler(config.policy, precision);
+    // what the samples and their verdicts depend on, for a checkpoint
+    ostringstream key;
+    key << pdrhfile << " " << config.unfoldings << " " << precision << " --timeout=" << timeout
+        << " --memory=" << memory << " --on-timeout=" << config.policy << " --sampling=" << config.sampling
+        << " --strata=" << config.strata << " --proposal=" << config.proposal;
+
+    // a sweep checks every sample at each unfolding level in turn
+    vector<int> depths = unfoldings(config.unfoldings);
+    unsigned levels = depths.size();
+    string kmax = std::to_string(depths.back());
+    if (levels > 1 && checkpoint != NULL) fail("--checkpoint does not log the levels of a sweep of the unfolding steps");
+    if (config.sampling == "ce" && (levels > 1 || checkpoint != NULL || config.cesamples == 0)) {
+        fail("--sampling=ce fits its proposals to one unfolding step, needs --ce-samples > 0, and does"
+             " not log them in a checkpoint (give the proposal it prints to --sampling=importance instead)");
+    }
+    say("Random seed: " + std::to_string(master));
+
+    // for each test create object, pass arguments, and initialize,
+    // once for every unfolding level
+    vector<unsigned> mylevels;          // the unfolding level of each
+    for (unsigned long j = 0; j < tests.size(); ++j) delete tests[j];
+    tests.clear();
+    for (unsigned lv = 0; lv < levels; ++lv) {
+        for (unsigned long i = 0; i < specs.size(); ++i) {
+            vector<Test *> some = make_tests(specs[i], NULL, master);
+            tests.insert(tests.end(), some.begin(), some.end());
+            mylevels.insert(mylevels.end(), some.size(), lv);
+        }
+    }
+    unsigned long numtests = tests.size();
+    vector<unsigned long> satnum(levels, 0);    // number of sat, at each unfolding level
+    vector<Weights> weights(levels);            // their likelihood ratios, for importance sampling
+    unsigned long totnum = 0;                   // number of total samples
+    timeouts = 0;
+    guesses = 0;
+    if (levels > 1) {
+        ostringstream line;
+        line << "Unfolding steps:";
+        for (unsigned lv = 0; lv < levels; ++lv) line << " " << depths[lv];
+        say(line.str());
+    }
+    if (numtests == 0) {
+        say("No test requested - exiting ...");
+        return results;
+    }
+
+    // the random variables and distributions of the model, compiled once
+    RVProgram rvprog(pdrh->distributions());
+    Sampler sampler(rvprog, config.sampling, config.strata, config.proposal, master);
+    // the sums of the stratified and Latin hypercube designs, at each level
+    vector<Designs> designs(sampler.designed() ? levels : 0, sampler.designs());
+
+    // the hypothesis tests need plain independent samples,
+    // or the exact probability
+    if (sampler.get() != Sampler::MONTECARLO && sampler.support() == 0) {
+        for (unsigned long j = 0; j < numtests; j++) {
+            if (dynamic_cast<HTest *>(tests[j]) != NULL) {
+                fail("hypothesis tests need --sampling=mc, or exact on a purely discrete model");
+            }
+        }
+    }
+    // an enumerated assignment cannot be drawn again
+    if (sampler.support() > 0 && straggler.get() == Straggler::REDRAW && (timeout > 0 || memory > 0)) {
+        fail("--sampling=exact on a purely discrete model needs --on-timeout=sat, unsat or coarsen");
+    }
+    if (sampler.support() > 0) say("Assignments to check: " + std::to_string(sampler.support()));
+
+    // split the drh model once, each sample only fills in the values
+    ModelTemplate model(*pdrh, rvprog);
+
+    // the dreach returns of all sampled assignments checked so far,
+    // by this engine or by those sharing the cache
+    SampleCache owncache;
+    SampleCache & cache = (shared != NULL) ? *shared : owncache;
+    // the boxes certified unsat, with --regions
+    std::unique_ptr<RegionCache> regions((config.regions > 0) ? new RegionCache(rvprog, config.regions) : NULL);
+    // every sample and its outcome, in sample order
+    delete store;
+    store = new SampleStore(rvprog);
+    // records the delta-sat and the unsat samples within the given (high) dimensional sample space
+    std::unique_ptr<SampleWriter> writer((config.output == "none") ? NULL : new SampleWriter(config.output, *store, dir));
+
+    // the threads are the engine's own, as many as the configuration says:
+    // by default one worker per processor the process may use and its CPU
+    // quota pays for, unless OMP_NUM_THREADS says otherwise, and no more
+    // than the memory limit holds runs at their own limit; plus the
+    // aggregator, which sleeps while no sample completes
+    Resources resources;
+    limits = resources.describe();
+    int numremote = config.remote;
+    workers = config.threads;
+    if (workers == 0 && pool != NULL) workers = pool->size();
+    if (workers == 0) {
+        workers = (getenv("OMP_NUM_THREADS") != NULL) ? omp_get_max_threads()
+                                                     : resources.workers(omp_get_max_threads());
+        if (resources.memory() > 0 && memory > 0) {
+            workers = max(1, std::min(workers, int(resources.memory() / (memory << 20))));
+        }
+    }
+    int numworkers = workers;
+
+    // start one dReach launcher per worker, before any thread is created,
+    // on the processors it is placed on; or borrow them from the pool
+    string pin = config.pin;
+    if (pin == "auto") pin = (resources.nodes().size() > 1) ? "nodes" : "none";
+    vector<std::unique_ptr<Launcher> > solvers;
+    for (int wid = 0; wid < numworkers; ++wid) {
+        solvers.push_back(std::unique_ptr<Launcher>(
+            (pool != NULL) ? new Launcher(*pool, reinterpret_cast<unsigned long>(this), kmax, precision)
+                           : new Launcher(new Solver(config.dreach, kmax, precision, piped, timeout, memory,
+                                                     resources.place(wid, pin)))));
+    }
+    // and let as many of them run at once as the memory, and the samples per second, allow;
+    // the pool shares its launchers out itself
+    Throttle throttle(resources, numworkers, config.tune && pool == NULL);
+
+    // the remote workers get the models from the threads after the local ones
+    vector<std::unique_ptr<RemoteSolver> > remotes;
+    if (numremote > 0) {
+        vector<RemoteSolver *> accepted = accept_workers(config.port, numremote, kmax, precision, timeout, memory);
+        for (unsigned long r = 0; r < accepted.size(); ++r) remotes.push_back(std::unique_ptr<RemoteSolver>(accepted[r]));
+    }
+    // the first error of a thread stops the run
+    Failure failure;
+
+    // fit the proposals of --sampling=ce first, on samples of their own
+    // that the run does not use, checked by the local workers
+    if (sampler.get() == Sampler::CROSSENTROPY) {
+        CrossEntropy ce(rvprog, atof(precision.c_str()));
+        if (ce.size() == 0) fail("--sampling=ce needs a uniform, normal or exponential random variable with constant parameters");
+        unsigned long cesamples = config.cesamples;
+        bool more = true;
+        for (unsigned long it = 0; more && it < config.ceiterations; ++it) {
+            vector<vector<double> > values(cesamples);
+            vector<double> ratios(cesamples);
+            vector<char> sat(cesamples, 0);
+            string delta = ce.precision();
+            std::atomic<unsigned long> taken(0);
+            auto fit = [&] (int wid) {
+                try {
+                    for (unsigned long i; !failure.happened() && (i = taken++) < cesamples; ) {
+                        Rng rng(master, PILOT + it * cesamples + i);
+                        ratios[i] = rvprog.sample(values[i], rng, ce.current());
+                        // a sample outside the declared ranges weighs nothing
+                        if (ratios[i] == 0) continue;
+                        string drhbuf;
+                        int r;
+                        if (piped) {
+                            model.instantiate(values[i], drhbuf);
+                            r = solvers[wid]->solve_piped(drhbuf, delta);
+                        } else {
+                            string name = dir + "/numodel_" + std::to_string(wid);
+                            model.write(values[i], name + ".drh", drhbuf);
+                            r = solvers[wid]->solve(name, delta);
+                        }
+                        sat[i] = (r == Solver::SAT);
+                    }
+                } catch (...) {
+                    failure.record();
+                }
+            };
+            vector<std::thread> fitters;
+            for (int wid = 0; wid < numworkers; ++wid) fitters.push_back(std::thread(fit, wid));
+            for (int wid = 0; wid < numworkers; ++wid) fitters[wid].join();
+            failure.rethrow();
+            // in sample order, so that the fit does not depend on the threads
+            for (unsigned long i = 0; i < cesamples; ++i) {
+                if (sat[i]) ce.elite(values[i], ratios[i]);
+            }
+            ostringstream line;
+            line << "Cross-entropy iteration " << it + 1 << ": precision = " << delta
+                 << ", sat = " << ce.elites() << " of " << cesamples;
+            more = ce.next(cesamples);
+            line << ", proposal: " << (ce.spec().empty() ? "none" : ce.spec());
+            say(line.str());
+        }
+        if (!ce.converged()) {
+            cerr << "Warning: the cross-entropy method stopped before a tenth of its samples were sat at "
+                 << precision << endl;
+        }
+        sampler.propose(ce.spec());
+        say("Proposal: " + ce.spec());
+    }
+
+    // the time each worker spends in each stage of a sample
+    delete metrics;
+    metrics = new Metrics(numworkers + numremote);
+    ofstream metricsout;
+    if (!config.metrics.empty()) {
+        metricsout.open(config.metrics.c_str());
+        if (!metricsout.is_open()) fail("cannot write the metrics: " + config.metrics);
+    }
+    Metrics::Clock::time_point streamed = Metrics::Clock::now();
+    ofstream progressout;
+    if (!config.progress.empty()) {
+        progressout.open(config.progress.c_str());
+        if (!progressout.is_open()) fail("cannot write the progress: " + config.progress);
+    }
+    Metrics::Clock::time_point published = Metrics::Clock::now();
+
+    WorkQueue work;
+    CompletionQueue completed;
+    // the samples drawn ahead, enough for every worker twice over
+    unsigned long batches = max(4UL, 2 * (numworkers + numremote) / max(config.batch, 1UL) + 1);
+    std::unique_ptr<Prefetch> prefetch((config.batch > 0) ? new Prefetch(sampler, work, config.batch, batches) : NULL);
+    work.limit(sampler.support() > 0 ? sampler.support() : needed(tests));
+    // the deepest unfolding level some test still needs
+    std::atomic<unsigned> top(levels - 1);
+    bool alldone = false;
+
+    // a test done: its line of the output, and its result
+    auto finish = [&] (unsigned long j) {
+        unsigned lv = mylevels[j];
+        tests[j]->setTimeouts(timeouts);
+        ostringstream line;
+        if (levels > 1) line << "k = " << depths[lv] << ": ";
+        tests[j]->printResult(line);
+        Result r;
+        r.k = depths[lv];
+        r.test = tests[j];
+        r.text = line.str();
+        r.text.erase(r.text.find_last_not_of('\n') + 1);
+        say(r.text);
+        results.push_back(r);
+    };
+
+    // take the next sample, in sample order: record it, and feed it
+    // to the tests; true once every test is done
+    auto consume = [&] (Outcome const & o) -> bool {
+
+        // record the sample within the given (high) dimensional sample space
+        store->add(o.assignment, o.result == 1);
+        if (writer != NULL) writer->update();
+
+        // update the num of sat samples and total samples; a sample
+        // sat at some unfolding level is sat at every deeper one
+        totnum++;
+        unsigned long cell = sampler.designed() ? sampler.cell(o.index) : 0;
+        for (unsigned lv = 0; lv < levels; ++lv) {
+            satnum[lv] += (o.depth <= lv);
+            weights[lv].add(o.weight, o.depth <= lv);
+            if (sampler.designed()) designs[lv].add(cell, o.depth <= lv);
+        }
+        timeouts += o.timeouts;
+        guesses += o.guessed;
+
+        // with every assignment of a purely discrete model checked,
+        // the tests are decided from the exact probability
+        if (sampler.support() > 0) {
+            bool over = (totnum == sampler.support());
+            if (over) {
+                for (unsigned lv = 0; lv < levels; ++lv) {
+                    ostringstream line;
+                    if (levels > 1) line << "k = " << depths[lv] << ": ";
+                    line << "Exact probability: " << weights[lv].wx / totnum;
+                    say(line.str());
+                }
+                for (unsigned long j = 0; j < numtests; j++) {
+                    unsigned lv = mylevels[j];
+                    tests[j]->decide(weights[lv].wx / totnum, totnum, satnum[lv]);
+                    finish(j);
+                }
+            }
+            return over;
+        }
+
+        // do all the tests
+        bool over = true;
+        unsigned deepest = 0;
+        for (unsigned long j = 0; j < numtests; j++) {
+
+            // do a test, if not done
+            unsigned lv = mylevels[j];
+            bool done = tests[j]->done();
+            if (!done) {
+                if (sampler.weighted()) tests[j]->doWeighted (totnum, satnum[lv], weights[lv]);
+                else if (sampler.designed()) tests[j]->doDesigned (totnum, satnum[lv], designs[lv]);
+                else tests[j]->doTest (totnum, satnum[lv]);
+                done = tests[j]->done();
+                if (done) {
+                    finish(j);
+                    work.limit(needed(tests));
+                }
+            }
+            if (!done) deepest = max(deepest, lv);
+            over = over && done;
+        }
+        // the later samples are not checked deeper than any test needs
+        top.store(deepest);
+        return over;
+    };
+
+    // the samples checked, as opposed to resumed, and since when
+    unsigned long resumed = 0;
+    Metrics::Clock::time_point began = Metrics::Clock::now();
+
+    // a line of JSON of where the run is: the samples, how many per second
+    // are checked, the state of every test, and the samples and seconds
+    // left until every test is done at that rate, null when there is no
+    // telling; the rate counts the samples taken, in sample order
+    auto publish = [&] (bool final) {
+        double elapsed = std::chrono::duration<double>(Metrics::Clock::now() - began).count();
+        double rate = (elapsed > 0) ? (totnum - resumed) / elapsed : 0;
+        uint64_t lookups = metrics->total(Metrics::SAMPLES);
+        progressout << "{\"elapsed\": " << elapsed << ", \"final\": " << (final ? "true" : "false")
+                    << ", \"samples\": " << totnum << ", \"sat\": [";
+        for (unsigned lv = 0; lv < levels; ++lv) {
+            progressout << (lv > 0 ? ", " : "") << "{\"k\": " << depths[lv] << ", \"sat\": " << satnum[lv] << "}";
+        }
+        progressout << "], \"rate\": " << rate << ", \"timeouts\": " << timeouts << ", \"guesses\": " << guesses
+                    << ", \"cache_hits\": " << (lookups > 0 ? double (metrics->total(Metrics::HITS)) / lookups : 0.0)
+                    << ", \"prefetched\": " << metrics->total(Metrics::PREFETCHED) << ", \"tests\": [";
+        unsigned long left = 0;
+        for (unsigned long j = 0; j < numtests; j++) {
+            unsigned lv = mylevels[j];
+            progressout << (j > 0 ? ", " : "") << "{\"k\": " << depths[lv] << ", ";
+            bool bounded = sampler.weighted() || sampler.designed();
+            tests[j]->progress(progressout, totnum, satnum[lv], sampler.weighted() ? &weights[lv] : NULL, bounded);
+            progressout << "}";
+            left = max(left, tests[j]->remaining(totnum, satnum[lv], bounded));
+        }
+        progressout << "], \"remaining\": ";
+        if (left == ULONG_MAX) progressout << "null, \"seconds_left\": null";
+        else if (rate > 0) progressout << left << ", \"seconds_left\": " << left / rate;
+        else progressout << left << ", \"seconds_left\": " << (left == 0 ? "0" : "null");
+        progressout << "}" << endl;
+    };
+
+    // a resumed run takes its samples so far from the checkpoint,
+    // and goes on from the first one it does not have
+    if (checkpoint != NULL) {
+        checkpoint->begin(key.str(), master, rvprog.size());
+        Checkpoint::Record r;
+        Outcome o;
+        while (checkpoint->next(r)) {
+            if (alldone) continue;
+            o.index = totnum;
+            o.result = r.sat ? 1 : 0;
+            o.depth = r.sat ? 0 : 1;
+            o.timeouts = r.timeouts;
+            o.weight = r.weight;
+            o.guessed = r.guessed;
+            o.assignment = r.assignment;
+            if (!r.guessed) cache.insert(o.assignment, o.result);
+            alldone = consume(o);
+        }
+        if (checkpoint->resumed()) say("Resumed after " + std::to_string(totnum) + " samples");
+        work.start(totnum);
+        resumed = totnum;
+        began = Metrics::Clock::now();
+    }
+
+    // the workers, local ones first, and the sampling stage, in threads of
+    // their own; the aggregator is the thread calling run, and an error of
+    // any of them stops the others
+    auto failed = [&] () {
+        failure.record();
+        completed.interrupt();
+    };
+    auto worker = [&] (int wid) {
+        try {
+            RemoteSolver * remote = (wid < numworkers) ? NULL : remotes[wid - numworkers].get();
+
+            // a different file name for each worker's drh file
+            string drhname = dir + "/numodel_" + std::to_string(wid);
+
+            unsigned long index;
+            vector<double> values;
+            string drhbuf;                  // reused for every instantiated model
+            Metrics::Clock::time_point t = Metrics::Clock::now();
+
+            // a local worker waits for its turn before it takes a sample
+            while ((remote != NULL || throttle.enter()) && work.next(index)) {
+
+                t = metrics->time(wid, Metrics::WAIT, t);
+
+                // sample according to the compiled distributions,
+                // from the random number stream of this sample index;
+                // a draw whose runs hit the limits may be drawn again from it
+                Rng rng(master, index);
+                std::unique_ptr<Outcome> o(new Outcome());
+                o->index = index;
+                o->timeouts = 0;
+                o->guessed = false;
+                int res = Solver::UNKNOWN;
+                // the sampling stage may have drawn it already
+                bool drawn = (prefetch != NULL && prefetch->take(index, values, o->weight, rng));
+
+                for (int draw = 0; res == Solver::UNKNOWN; ++draw) {
+
+                    if (draw == Straggler::REDRAWS) {
+                        fail(std::to_string(draw) + " draws of a sample all hit the limits of dReach");
+                    }
+                    if (draw > 0 || !drawn) o->weight = sampler.sample(index, values, rng);
+                    else metrics->count(wid, Metrics::PREFETCHED);
+                    t = metrics->time(wid, Metrics::SAMPLE, t);
+
+                    // check whether the assignment has been checked already: the
+                    // cache holds 2 * level + 1 for sat from that unfolding level on,
+                    // and 2 * level for unsat up to that level
+                    int cached = cache.lookup(values);
+                    unsigned deepest = top.load();
+                    unsigned from = 0;          // the first level left to check
+                    o->depth = levels;
+                    o->result = SampleCache::UNKNOWN;
+                    if (cached != SampleCache::UNKNOWN) {
+                        if (cached % 2 == 1) o->depth = cached / 2;
+                        if (cached % 2 == 1 || unsigned(cached / 2) >= deepest) o->result = (cached % 2);
+                        else from = cached / 2 + 1;
+                    }
+                    t = metrics->time(wid, Metrics::LOOKUP, t);
+                    metrics->count(wid, Metrics::SAMPLES);
+                    if (o->result != SampleCache::UNKNOWN) metrics->count(wid, Metrics::HITS);
+
+                    if (o->result == 1) {
+                        say("no need to call dreach, sat");
+                        res = Solver::SAT;
+                    }
+                    else if (o->result == 0){
+                        say("no need to call dreach, unsat");
+                        res = Solver::UNSAT;
+                    }
+                    else if (from == 0 && regions != NULL && regions->covered(values)) {
+                        t = metrics->time(wid, Metrics::LOOKUP, t);
+                        metrics->count(wid, Metrics::REGIONS);
+                        say("no need to call dreach, unsat in a certified box");
+                        o->result = 0;
+                        res = Solver::UNSAT;
+                    }else{
+                        // call dReach, at each level over the unfolding steps
+                        // the level before did not cover, until one is sat
+                        bool guessed = false;
+                        int lower = 0, upper = -1;
+                        auto dreach = [&] (string const & delta) {
+                            int r;
+                            if (remote != NULL || piped) {
+                                model.instantiate(values, drhbuf);
+                                t = metrics->time(wid, Metrics::MODEL, t);
+                                r = (remote != NULL) ? remote->solve_piped(drhbuf, delta, lower, upper)
+                                                     : solvers[wid]->solve_piped(drhbuf, delta, lower, upper);
+                            } else {
+                                model.write(values, drhname + ".drh", drhbuf);
+                                t = metrics->time(wid, Metrics::MODEL, t);
+                                r = solvers[wid]->solve(drhname, delta, lower, upper);
+                            }
+                            t = metrics->time(wid, Metrics::SOLVE, t);
+                            metrics->count(wid, Metrics::SOLVES);
+                            return r;
+                        };
+                        unsigned lv = from;
+                        for (; lv <= deepest; ++lv) {
+                            if (levels > 1) {
+                                lower = (lv == 0) ? 0 : depths[lv - 1] + 1;
+                                upper = depths[lv];
+                            }
+                            bool guess;
+                            res = straggler.check([&] (string const & delta) {
+                                // unsat at the coarse precision is unsat at any finer one,
+                                // only the rest is checked again at the precision asked for
+                                if (config.coarse.empty() || !delta.empty()) return dreach(delta);
+                                int r = dreach(config.coarse);
+                                metrics->count(wid, Metrics::COARSE);
+                                if (r != Solver::SAT && r != Solver::UNKNOWN) return r;
+                                metrics->count(wid, Metrics::RECHECKS);
+                                return dreach(delta);
+                            }, o->timeouts, guess);
+                            guessed = guessed || guess;
+                            if (res != Solver::UNSAT) break;
+                        }
+                        if (res == Solver::SAT || res == Solver::UNSAT) {
+                            o->result = (res == Solver::SAT) ? 1 : 0;
+                            if (res == Solver::SAT) o->depth = lv;
+                            // a guess is not a verdict to be reused
+                            o->guessed = guessed;
+                            if (!guessed) cache.insert(values, (res == Solver::SAT) ? 2 * lv + 1 : 2 * deepest);
+                        }
+                        // check the box around an unsat sample once, at the coarse
+                        // precision if any: only an unsat box is of use
+                        vector<double> lo, hi;
+                        if (res == Solver::UNSAT && !guessed && regions != NULL && regions->around(values, lo, hi)) {
+                            model.instantiate_box(lo, hi, drhbuf);
+                            t = metrics->time(wid, Metrics::MODEL, t);
+                            int r;
+                            if (remote != NULL) {
+                                r = remote->solve_piped(drhbuf, config.coarse);
+                            } else if (piped) {
+                                r = solvers[wid]->solve_piped(drhbuf, config.coarse);
+                            } else {
+                                ModelTemplate::save(drhbuf, drhname + ".drh");
+                                r = solvers[wid]->solve(drhname, config.coarse);
+                            }
+                            t = metrics->time(wid, Metrics::SOLVE, t);
+                            metrics->count(wid, Metrics::SOLVES);
+                            metrics->count(wid, Metrics::BOXES);
+                            if (r == Solver::SAT || r == Solver::UNSAT || r == Solver::UNKNOWN) {
+                                regions->certified(lo, hi, r == Solver::UNSAT);
+                            }
+                        }
+                    }
+                }
+                metrics->count(wid, Metrics::TIMEOUTS, o->timeouts);
+
+                if (remote != NULL && res == RemoteSolver::LOST) {
+                    // another worker takes the sample over
+                    if (!work.isclosed()) {
+                        cerr << "Warning: lost the remote worker at " << remote->address() << endl;
+                        work.retry(index);
+                    }
+                    break;
+                }
+                if (res == Solver::CANCELLED) {
+                    break;
+                }
+
+                o->assignment = values;
+                completed.push(o.release());
+                if (remote == NULL) throttle.leave(solvers[wid]->peak());
+            }
+        } catch (...) {
+            failed();
+        }
+    };
+    vector<std::thread> threads;
+    for (int wid = 0; wid < numworkers + numremote; ++wid) threads.push_back(std::thread(worker, wid));
+    if (prefetch) {
+        // the sampling stage
+        threads.push_back(std::thread([&] () {
+            try {
+                prefetch->run();
+            } catch (...) {
+                failed();
+            }
+        }));
+    }
+
+    // the aggregator: outcomes arriving out of order wait here
+    std::map<unsigned long, Outcome *> pending;
+    try {
+        while (! alldone && ! failure.happened()) {
+
+            Metrics::Clock::time_point waiting = Metrics::Clock::now();
+            Outcome * first = completed.wait();
+            metrics->waited(std::chrono::duration<double>(Metrics::Clock::now() - waiting).count());
+            for (Outcome * o = first; o != NULL; ) {
+                Outcome * n = o->next;
+                pending[o->index] = o;
+                o = n;
+            }
+
+            while (! alldone && ! failure.happened() && ! pending.empty() && pending.begin()->first == totnum) {
+
+                std::unique_ptr<Outcome> o(pending.begin()->second);
+                pending.erase(pending.begin());
+
+                alldone = consume(*o);
+                if (checkpoint != NULL) {
+                    Checkpoint::Record r;
+                    r.sat = (o->result == 1);
+                    r.guessed = o->guessed;
+                    r.timeouts = o->timeouts;
+                    r.weight = o->weight;
+                    r.assignment = o->assignment;
+                    checkpoint->add(r);
+                }
+
+                if (metricsout.is_open() && Metrics::Clock::now() - streamed >= std::chrono::seconds(1)) {
+                    metrics->json(metricsout, false);
+                    streamed = Metrics::Clock::now();
+                }
+                if (progressout.is_open() && Metrics::Clock::now() - published >= std::chrono::seconds(1)) {
+                    publish(false);
+                    published = Metrics::Clock::now();
+                }
+            }
+        }
+    } catch (...) {
+        failed();
+    }
+
+    // stop handing out samples, and kill the solves still running,
+    // no test can use their verdicts
+    work.close();
+    throttle.close();
+    if (prefetch != NULL) prefetch->stop();
+    for (int wid = 0; wid < numworkers; ++wid) {
+        solvers[wid]->cancel();
+    }
+    for (unsigned long r = 0; r < remotes.size(); ++r) {
+        remotes[r]->stop();
+    }
+
+    for (std::map<unsigned long, Outcome *>::iterator it = pending.begin(); it != pending.end(); ++it) {
+        delete it->second;
+    }
+    for (unsigned long t = 0; t < threads.size(); ++t) threads[t].join();
+    failure.rethrow();
+
+    if (metricsout.is_open()) metrics->json(metricsout, true);
+    if (progressout.is_open()) publish(true);
+    boxes = (regions != NULL) ? regions->size() : 0;
+    if (writer != NULL) writer->flush();
+    concurrent = throttle.current();
+    lowest = throttle.lowest();
+    rss = 0;
+    for (int wid = 0; wid < numworkers; ++wid) {
+        rss = max(rss, solvers[wid]->peak());
+    }
+    return results;
+}
+
+}
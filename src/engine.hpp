@@ -0,0 +1,178 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include <mutex>
+#include <memory>
+#include "stattest.hpp"
+#include "metrics.hpp"
+#include "samplestore.hpp"
+#include "samplecache.hpp"
+#include "solverpool.hpp"
+#include "pdrh.hpp"
+
+class Options;
+
+namespace sreach {
+
+// how a run is made, one field per option of sreach_para
+struct Config {
+    std::string dreach;                 // the dReach executable
+    std::string unfoldings;             // the unfolding steps k, or the sweep <from>:<to>[:<step>]
+    std::string precision;              // the delta of the delta-decision procedure
+    int threads;                        // local workers, 0 for one per processor the process may use
+    bool seeded;                        // the master seed is given, else drawn at random
+    unsigned long seed;
+    bool piped;                         // --io=pipe, else file
+    double timeout;                     // --timeout and --memory of every dReach run, 0 for none
+    unsigned long memory;
+    std::string policy;                 // --on-timeout
+    std::string sampling;               // --sampling, with --strata, --proposal,
+    unsigned long strata;               // --ce-samples and --ce-iterations
+    std::string proposal;
+    unsigned long cesamples, ceiterations;
+    std::string output;                 // --output, or none to write no sample file
+    std::string directory;              // where the models and the sample files of the run go
+    std::string checkpoint;             // --checkpoint, empty for none, with --resume
+    bool resume;                        // and --checkpoint-every
+    double every;
+    std::string metrics;                // --metrics, empty for none
+    std::string progress;               // --progress, empty for none
+    std::string coarse;                 // the precision of --coarse, empty for none
+    double regions;                     // the box size of --regions, 0 for none
+    unsigned long batch;                // --batch
+    unsigned long port, remote;         // --listen and --remote, 0 for none
+    std::string pin;                    // --pin
+    bool tune;                          // --tune=on, else off
+    std::ostream * log;                 // what sreach_para prints while it runs, NULL (the default) for nothing
+
+    // the defaults of the options
+    Config ();
+};
+
+// the options of sreach_para after its positional arguments, into the
+// configuration with the unfolding steps and the precision set already
+void take_options (Options & opts, Config & config);
+
+// a test once it is done
+struct Result {
+    int k;                              // the unfolding steps it ran at
+    Test const * test;                  // its outcome, samples and estimate
+    std::string text;                   // its line of the output
+};
+
+// one run of statistical model checking in process: a pdrh model, the
+// tests, and the workers checking the sampled models with dReach, with
+// the files of the run in the directory of the configuration
+// the errors of load, test, read and run are thrown as an Error; the
+// master seed and the threads are the engine's own, so engines with
+// directories of their own may run side by side, on a model, a pool of
+// dReach launchers and a cache of verdicts they share
+class Engine {
+private:
+    Config config;
+    std::string pdrhfile;
+    std::shared_ptr<PdrhModel const> pdrh;      // the model, read once and shared by the workers
+    SolverPool * pool;                  // the launchers shared with other engines, NULL for its own
+    SampleCache * shared;               // the verdicts shared with other engines, NULL for its own
+    std::vector<std::string> specs;     // the lines of the tests
+    std::vector<Test *> tests;          // once for every unfolding level
+    std::vector<Result> results;
+    unsigned long master;               // the seed of the run
+    int workers;
+    unsigned long timeouts;             // dReach runs over the limits
+    unsigned long guesses;              // samples whose verdict is the --on-timeout policy's
+    unsigned long boxes;                // certified unsat
+    std::string limits;                 // the CPU and memory limits found
+    unsigned concurrent, lowest;        // dReach runs at once, at the end and at the least
+    unsigned long rss;                  // the largest peak resident set of a run, in kB
+    Metrics * metrics;
+    SampleStore * store;
+    std::mutex logging;
+
+    // a line of the output
+    void say (std::string const & line);
+
+    Engine (Engine const &);
+    Engine & operator= (Engine const &);
+
+public:
+    Engine (Config const & config);
+    ~Engine ();
+
+    // the probabilistic model, a pdrh file, read at once; or read
+    // already, as the named file, and shared with other engines
+    void load (std::string const & pdrhfile);
+    void load (std::shared_ptr<PdrhModel const> model, std::string const & pdrhfile);
+
+    // check the samples on launchers borrowed from the pool for each run,
+    // as many at once as the threads, instead of on launchers of its own:
+    // the --io, --timeout and --memory of the pool hold, and --pin and
+    // --tune are left to it
+    void share (SolverPool & launchers);
+
+    // take and record the verdicts in a cache shared with the engines
+    // of the same model, unfolding steps and precision, instead of one
+    // of its own
+    void share (SampleCache & verdicts);
+
+    PdrhModel const & model () const {
+        return *pdrh;
+    }
+
+    // the tests of a line of a test file, or of a whole test file
+    void test (std::string const & spec);
+    void read (std::string const & testfile);
+
+    // run every test to its end; the results, in the order the tests ended
+    std::vector<Result> const & run ();
+
+    unsigned long seed () const {
+        return master;
+    }
+
+    // the largest peak resident set of a dReach run, in kB
+    unsigned long peak () const {
+        return rss;
+    }
+
+    // every sample of the run and its outcome, in sample order
+    SampleStore const & samples () const {
+        return *store;
+    }
+
+    // the summary printed at the end of a run
+    void report (std::ostream & out) const;
+};
+
+}
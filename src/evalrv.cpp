@@ -28,17 +28,15 @@
  * inability to use, this software or its associated documentation, even if the
  * authors have been advised of the possibility of those damages.
  * ***********************************************************************************************/
-
-// evaluate the +/-/*// expressions in the current rv file
-// return the final version of rv file
+// evaluate the +/-/*//^ expressions of the random variable declarations,
+// compiled once and then evaluated for every sample
 
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
 #include <cctype>
-#include <stack>
+#include <cmath>
 #include <vector>
+#include <map>
 #include <stdlib.h>
 #include <algorithm>
 #include "evalrv.hpp"
@@ -46,45 +44,7 @@
 using namespace std;
 
 
-//compare the binding priorities between two operators
-char cmp(char a,char b)
-{
-    switch(a)
-    {
-        case '#': // the lowest priority
-            return ('#' == b)? '=' : '<';
-            break;
-            
-        case '-':
-        case '+':
-        {
-            if('*' == b || '/' == b || '(' == b)
-            {
-                return '<';
-            }
-            else
-            {
-                return '>';
-            }
-        }
-            break;
-            
-        case '*':
-        case '/':
-        {
-            return ('('==b)?'<':'>';
-        }
-            break;
-            
-        case '(':
-            return (')'==b)?'=':'<';
-            break;
-        default:
-            throw "error:unkown operator";
-    }
-}
-
-//compute the results for "+,-,*,/" for reals
+//compute the results for "+,-,*,/,^" for reals
 double calc(double a, double b, char op)
 {
     switch(op)
@@ -97,102 +57,164 @@ double calc(double a, double b, char op)
             return a*b;
         case '/':
             if(b == 0)
-                throw "error: the divisor shoud not be negtive.";
+                throw "error: the divisor shoud not be zero.";
             else
                 return a/b;
+        case '^':
+            return pow(a, b);
         default:
             throw "error: unknown operator.";
     }
 }
 
-//tell whether the current char c is an operator
-bool isoptr(char c)
+static void skip (string const & text, size_t & pos)
+{
+    while (pos < text.size() && isspace(text[pos])) ++pos;
+}
+
+Expr::Expr (string const & text, map<string, int> const & names) : depth(0)
+{
+    size_t pos = 0;
+    sum(text, pos, names);
+    skip(text, pos);
+    if (pos < text.size())
+    {
+        throw (text[pos] == ')') ? "error: unbalanced parentheses." : "error: unknown char.";
+    }
+}
+
+void Expr::emit (Code c, double num, int slot)
 {
-    // legal operators
-    static string optrs("+-*/()#");
-    
-    if(optrs.find(c) == string::npos)
+    Op op;
+    op.code = c;
+    op.num = num;
+    op.slot = slot;
+    code.push_back(op);
+
+    // operands push one value, binary operators pop one
+    if (c == NUM || c == VAR)
     {
-        if(isdigit(c))
-            return false;
-        else if(c == '.')
-            return false;
-        else
-            throw "error: unknown char.";
+        if (++depth > MAXDEPTH) throw "error: expression nested too deep.";
+    }
+    else if (c != NEG)
+    {
+        depth--;
     }
-    return true;
 }
 
-//compute the value of expression e
-double eval(std::string e)
+// sum := product (('+' | '-') product)*
+void Expr::sum (string const & text, size_t & pos, map<string, int> const & names)
 {
-    e += "#"; // # indicates the end of the expression
-    stack<double> opnd;
-    stack<char> optr;
-    optr.push('#');
-    int i = 0;  // starts with the init of e
-    double num = 0;
-    
-    while(e[i] != '#' || optr.top() != '#')
+    product(text, pos, names);
+    for (skip(text, pos); pos < text.size() && (text[pos] == '+' || text[pos] == '-'); skip(text, pos))
     {
-        
-        if(!isoptr(e[i]))
-        {
-            stringstream ss;
-            string s;
-            while(!isoptr(e[i]))
-            {
-                ss << e[i];
-                ++i;
-            }
-            ss >> s;
-            const char * c = s.c_str();
-            num = atof(c);
-            //cout << num << endl;
-            opnd.push(num);
-        }
-        
-        else
+        char op = text[pos++];
+        product(text, pos, names);
+        emit(op == '+' ? ADD : SUB);
+    }
+}
+
+// product := unary (('*' | '/') unary)*
+void Expr::product (string const & text, size_t & pos, map<string, int> const & names)
+{
+    unary(text, pos, names);
+    for (skip(text, pos); pos < text.size() && (text[pos] == '*' || text[pos] == '/'); skip(text, pos))
+    {
+        char op = text[pos++];
+        unary(text, pos, names);
+        emit(op == '*' ? MUL : DIV);
+    }
+}
+
+// unary := ('-' | '+') unary | power, so that -2^2 is -(2^2)
+void Expr::unary (string const & text, size_t & pos, map<string, int> const & names)
+{
+    skip(text, pos);
+    if (pos < text.size() && (text[pos] == '-' || text[pos] == '+'))
+    {
+        char op = text[pos++];
+        unary(text, pos, names);
+        if (op == '-') emit(NEG);
+        return;
+    }
+    power(text, pos, names);
+}
+
+// power := number | name | '(' sum ')', then '^' unary, right associative
+void Expr::power (string const & text, size_t & pos, map<string, int> const & names)
+{
+    skip(text, pos);
+    if (pos == text.size()) throw "error: opnd is empty.";
+
+    char c = text[pos];
+    if (c == '(')
+    {
+        ++pos;
+        sum(text, pos, names);
+        skip(text, pos);
+        if (pos == text.size() || text[pos] != ')') throw "error: unbalanced parentheses.";
+        ++pos;
+    }
+    else if (isdigit(c) || c == '.')
+    {
+        // with an exponent, as strtod reads it
+        char const * start = text.c_str() + pos;
+        char * end;
+        double num = strtod(start, &end);
+        if (end == start) throw "error: bad number.";
+        pos += end - start;
+        emit(NUM, num);
+    }
+    else if (isalpha(c) || c == '_')
+    {
+        size_t j = pos;
+        while (j < text.size() && (isalnum(text[j]) || text[j] == '_')) ++j;
+        map<string, int>::const_iterator it = names.find(text.substr(pos, j - pos));
+        if (it == names.end()) throw "error: unknown name.";
+        if (find(slots.begin(), slots.end(), it->second) == slots.end()) slots.push_back(it->second);
+        emit(VAR, 0, it->second);
+        pos = j;
+    }
+    else
+    {
+        throw (c == ')') ? "error: opnd is empty." : "error: unknown char.";
+    }
+
+    skip(text, pos);
+    if (pos < text.size() && text[pos] == '^')
+    {
+        ++pos;
+        unary(text, pos, names);
+        emit(POW);
+    }
+}
+
+double Expr::value (vector<double> const & vars) const
+{
+    double stack[MAXDEPTH];
+    int top = 0;
+
+    if (code.empty()) throw "error: opnd is empty.";
+    for (vector<Op>::const_iterator op = code.begin(); op != code.end(); ++op)
+    {
+        switch (op->code)
         {
-            if(optr.empty())
-            {
-                throw "error: optr is empty";
-            }
-            switch(cmp(optr.top(),e[i]))
-            {
-                case '<':
-                    optr.push(e[i]);
-                    ++i;
-                    break;
-              
-                case '=':
-                    optr.pop();
-                    ++i;
-                    break;
-               
-                case '>':
-                    if(opnd.empty())
-                    {
-                        throw "error: opnd is empty.";
-                    }
-                    
-                    double a = opnd.top();
-                    //cout << a << endl;
-                    opnd.pop();
-                    if(opnd.empty())
-                    {
-                        throw "error: opnd is empty.";
-                    }
-                    
-                    double b = opnd.top();
-                    //cout << b << endl;
-                    opnd.pop();
-                    
-                    opnd.push(calc(b, a, optr.top()));
-                    optr.pop();
-                    break;
-            }
+            case NUM: stack[top++] = op->num; break;
+            case VAR: stack[top++] = vars[op->slot]; break;
+            case NEG: stack[top - 1] = -stack[top - 1]; break;
+            case ADD: --top; stack[top - 1] = calc(stack[top - 1], stack[top], '+'); break;
+            case SUB: --top; stack[top - 1] = calc(stack[top - 1], stack[top], '-'); break;
+            case MUL: --top; stack[top - 1] = calc(stack[top - 1], stack[top], '*'); break;
+            case DIV: --top; stack[top - 1] = calc(stack[top - 1], stack[top], '/'); break;
+            case POW: --top; stack[top - 1] = calc(stack[top - 1], stack[top], '^'); break;
         }
     }
-    return opnd.top();
+    return stack[0];
+}
+
+//compute the value of expression e
+double eval(std::string e)
+{
+    static const map<string, int> none;
+    return Expr(e, none).value(vector<double>());
 }
@@ -32,9 +32,54 @@
 #include <string>
 #include <cctype>
 #include <vector>
+#include <map>
 #include <stdlib.h>
-char cmp(char a,char b);
+
+// an arithmetic expression compiled once into postfix code: numbers,
+// + - * / ^, unary minus and parentheses, over named variables that
+// are given by their slot in the vector the expression is evaluated on
+// errors are thrown as char const *, as by calc()
+class Expr {
+public:
+    static const int MAXDEPTH = 64;     // values on the evaluation stack, at most
+
+    Expr () : depth(0) {
+    }
+
+    // names maps every variable the text may use to its slot
+    Expr (std::string const & text, std::map<std::string, int> const & names);
+
+    // the slots the expression reads, each once
+    std::vector<int> const & uses () const {
+        return slots;
+    }
+
+    // the value with vars[slot] for each variable, without allocating
+    double value (std::vector<double> const & vars) const;
+
+private:
+    enum Code { NUM, VAR, ADD, SUB, MUL, DIV, POW, NEG };
+
+    struct Op {
+        Code code;
+        double num;                     // the number of NUM
+        int slot;                       // the variable of VAR
+    };
+
+    std::vector<Op> code;
+    std::vector<int> slots;
+    int depth;                          // of the stack while compiling
+
+    // recursive descent over text from pos, appending to code
+    void sum (std::string const & text, size_t & pos, std::map<std::string, int> const & names);
+    void product (std::string const & text, size_t & pos, std::map<std::string, int> const & names);
+    void unary (std::string const & text, size_t & pos, std::map<std::string, int> const & names);
+    void power (std::string const & text, size_t & pos, std::map<std::string, int> const & names);
+    void emit (Code c, double num = 0, int slot = -1);
+};
+
 double calc(double a, double b, char op);
-bool isoptr(char c);
+
+// the value of an expression without variables
 double eval(std::string e);
 //std::vector<std::string> evalrv(std::vector<std::string> & currRVfile);
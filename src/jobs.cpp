@@ -0,0 +1,85 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// start the runs of sreach_bench and sreach_batch
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "jobs.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::cerr;
+using std::endl;
+
+string absolute (string const & path) {
+    char * real = realpath(path.c_str(), NULL);
+    if (real == NULL) return path;
+    string result = real;
+    free(real);
+    return result;
+}
+
+string subdir (string const & dir, string const & name) {
+    if (dir.empty() || dir == ".") return name;
+    return (dir[dir.size() - 1] == '/') ? dir + name : dir + "/" + name;
+}
+
+pid_t spawn (vector<string> const & args, string const & dir, string const & log, unsigned long threads) {
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        fail("cannot create the directory: " + dir);
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        fail("cannot fork: " + std::string(strerror(errno)));
+    }
+    if (pid > 0) return pid;
+
+    if (chdir(dir.c_str()) != 0) _exit(127);
+    int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        dup2(fd, 1);
+        dup2(fd, 2);
+        close(fd);
+    }
+    if (threads > 0) setenv("OMP_NUM_THREADS", std::to_string(threads).c_str(), 1);
+    vector<char *> argv;
+    for (size_t i = 0; i < args.size(); ++i) argv.push_back(const_cast<char *>(args[i].c_str()));
+    argv.push_back(NULL);
+    execv(argv[0], &argv[0]);
+    _exit(127);
+}
@@ -0,0 +1,159 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// the per-stage timers and counters of --metrics
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+#include "metrics.hpp"
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::endl;
+
+static char const * const NAMES[] = { "sample", "lookup", "model", "solve", "wait" };
+
+string stage_name (Metrics::Stage stage) {
+    return NAMES[stage];
+}
+
+Metrics::Metrics (int n) : workers(n), aggregator(0), started(Clock::now()) {
+    for (int w = 0; w < n; ++w) {
+        for (int s = 0; s < STAGES; ++s) workers[w].nanos[s] = 0;
+        for (int c = 0; c < COUNTERS; ++c) workers[w].counts[c] = 0;
+        for (int b = 0; b < BUCKETS; ++b) workers[w].latency[b] = 0;
+    }
+}
+
+Metrics::Clock::time_point Metrics::time (int worker, Stage stage, Clock::time_point start) {
+    Clock::time_point now = Clock::now();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+    Worker & w = workers[worker];
+    add(w.nanos[stage], ns);
+    if (stage == SOLVE) {
+        int b = 0;
+        for (uint64_t ms = ns / 1000000; ms > 0 && b < BUCKETS - 1; ms >>= 1) b++;
+        add(w.latency[b], 1);
+    }
+    return now;
+}
+
+void Metrics::count (int worker, Counter counter, unsigned long n) {
+    add(workers[worker].counts[counter], n);
+}
+
+void Metrics::waited (double s) {
+    add(aggregator, uint64_t(s * 1e9));
+}
+
+uint64_t Metrics::total (Counter c) const {
+    uint64_t n = 0;
+    for (unsigned long w = 0; w < workers.size(); ++w) n += workers[w].counts[c].load(std::memory_order_relaxed);
+    return n;
+}
+
+double Metrics::seconds (int worker, Stage stage) const {
+    return workers[worker].nanos[stage].load(std::memory_order_relaxed) / 1e9;
+}
+
+double Metrics::quantile (double q) const {
+    vector<uint64_t> buckets(BUCKETS, 0);
+    uint64_t n = 0;
+    for (unsigned long w = 0; w < workers.size(); ++w) {
+        for (int b = 0; b < BUCKETS; ++b) {
+            buckets[b] += workers[w].latency[b].load(std::memory_order_relaxed);
+        }
+    }
+    for (int b = 0; b < BUCKETS; ++b) n += buckets[b];
+    if (n == 0) return 0;
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += buckets[b];
+        if (seen >= q * n) return double(1UL << b);
+    }
+    return double(1UL << (BUCKETS - 1));
+}
+
+void Metrics::report (ostream & out) const {
+    double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+    uint64_t samples = total(SAMPLES), hits = total(HITS);
+
+    out << "Samples: " << samples << " in " << elapsed << " s, "
+        << (elapsed > 0 ? samples / elapsed : 0) << " per second" << endl;
+    out << "Sample cache: " << hits << " hits of " << samples << " lookups";
+    if (samples > 0) out << " (" << 100.0 * hits / samples << "%)";
+    out << endl;
+    if (total(BOXES) > 0) {
+        out << "Region cache: " << total(REGIONS) << " samples inside certified boxes, "
+            << total(BOXES) << " boxes checked" << endl;
+    }
+    if (total(PREFETCHED) > 0) {
+        out << "Drawn ahead: " << total(PREFETCHED) << " of " << samples << " samples" << endl;
+    }
+    if (total(COARSE) > 0) {
+        out << "Coarse precision: " << total(COARSE) << " samples checked, "
+            << total(RECHECKS) << " checked again" << endl;
+    }
+    out << "dReach runs: " << total(SOLVES) << ", over the limits: " << total(TIMEOUTS)
+        << ", latency (ms, upper bounds): median " << quantile(0.5) << ", 90% " << quantile(0.9)
+        << ", 99% " << quantile(0.99) << ", max " << quantile(1.0) << endl;
+    out << "Seconds per worker:";
+    for (int s = 0; s < STAGES; ++s) out << " " << NAMES[s];
+    out << endl;
+    for (unsigned long w = 0; w < workers.size(); ++w) {
+        out << "  " << w << ":";
+        for (int s = 0; s < STAGES; ++s) out << " " << seconds(w, Stage(s));
+        out << endl;
+    }
+    out << "Waiting for samples to aggregate: " << aggregator.load() / 1e9 << " s" << endl;
+}
+
+void Metrics::json (ostream & out, bool final) const {
+    double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+    out << "{\"elapsed\": " << elapsed << ", \"final\": " << (final ? "true" : "false")
+        << ", \"samples\": " << total(SAMPLES) << ", \"hits\": " << total(HITS)
+        << ", \"solves\": " << total(SOLVES) << ", \"timeouts\": " << total(TIMEOUTS)
+        << ", \"regions\": " << total(REGIONS) << ", \"boxes\": " << total(BOXES)
+        << ", \"coarse\": " << total(COARSE) << ", \"rechecks\": " << total(RECHECKS)
+        << ", \"prefetched\": " << total(PREFETCHED)
+        << ", \"latency_ms\": {\"p50\": " << quantile(0.5) << ", \"p90\": " << quantile(0.9)
+        << ", \"p99\": " << quantile(0.99) << ", \"max\": " << quantile(1.0) << "}"
+        << ", \"aggregator_wait\": " << aggregator.load() / 1e9 << ", \"workers\": [";
+    for (unsigned long w = 0; w < workers.size(); ++w) {
+        out << (w > 0 ? ", {" : "{");
+        for (int s = 0; s < STAGES; ++s) {
+            out << (s > 0 ? ", " : "") << "\"" << NAMES[s] << "\": " << seconds(w, Stage(s));
+        }
+        out << ", \"samples\": " << workers[w].counts[SAMPLES].load(std::memory_order_relaxed) << "}";
+    }
+    out << "]}" << endl;
+}
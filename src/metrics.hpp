@@ -0,0 +1,110 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+// timers and counters of the stages every sample goes through, one set
+// per worker: each worker only adds to its own, with relaxed atomics, so
+// that timing a stage costs two clock reads, while a report can be taken
+// at any time
+class Metrics {
+public:
+    enum Stage {
+        SAMPLE,                         // drawing the assignment
+        LOOKUP,                         // the sample cache
+        MODEL,                          // instantiating the drh model
+        SOLVE,                          // dReach, and reading its verdict
+        WAIT,                           // waiting for a sample index
+        STAGES
+    };
+
+    enum Counter {
+        SAMPLES, HITS, SOLVES, TIMEOUTS,
+        REGIONS,                        // samples inside a certified unsat box
+        BOXES,                          // dReach runs on a box
+        COARSE,                         // points checked at the coarse precision
+        RECHECKS,                       // and again at the precision asked for
+        PREFETCHED,                     // samples drawn ahead by the sampling stage
+        COUNTERS
+    };
+
+    // solve latencies, bucket b for [2^(b-1), 2^b) milliseconds, 0 below 1
+    static const int BUCKETS = 24;
+
+    typedef std::chrono::steady_clock Clock;
+
+    Metrics (int workers);
+
+    // add the time since start to a stage of a worker; return the time now
+    Clock::time_point time (int worker, Stage stage, Clock::time_point start);
+
+    void count (int worker, Counter counter, unsigned long n = 1);
+
+    // the time the aggregator waited for samples
+    void waited (double seconds);
+
+    // the summary, printed at the end of a run
+    void report (std::ostream & out) const;
+
+    // the same as one line of JSON
+    void json (std::ostream & out, bool final) const;
+
+    // a counter summed over the workers
+    uint64_t total (Counter c) const;
+
+private:
+    struct Worker {
+        std::atomic<uint64_t> nanos[STAGES];
+        std::atomic<uint64_t> counts[COUNTERS];
+        std::atomic<uint64_t> latency[BUCKETS];
+        char pad[64];                   // keep the workers off each other's cache lines
+    };
+
+    std::vector<Worker> workers;
+    std::atomic<uint64_t> aggregator;   // nanoseconds waited
+    Clock::time_point started;
+
+    static void add (std::atomic<uint64_t> & a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    double seconds (int worker, Stage stage) const;
+    // the upper end of the bucket the given fraction of the solves is in
+    double quantile (double q) const;
+};
+
+// the stage names of the report
+std::string stage_name (Metrics::Stage stage);
@@ -0,0 +1,92 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// parse the optional command line arguments shared by sreach_sq and sreach_para
+#include <iostream>
+#include <cstdlib>
+#include "options.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::cerr;
+using std::endl;
+
+Options::Options (int argc, char ** argv, int first) {
+    for (int i = first; i < argc; ++i) {
+        string arg(argv[i]);
+        if (arg.compare(0, 2, "--") != 0 || arg.size() == 2) {
+            fail("options must look like --<name>=<value>: " + arg);
+        }
+        size_t eq = arg.find('=');
+        if (eq == string::npos) values[arg.substr(2)] = "";
+        else values[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+}
+
+bool Options::has (string const & name) const {
+    return values.count(name) > 0;
+}
+
+string Options::take (string const & name, string const & def) {
+    std::map<string, string>::iterator it = values.find(name);
+    if (it == values.end()) return def;
+    string v = it->second;
+    values.erase(it);
+    return v;
+}
+
+unsigned long Options::take_ulong (string const & name, unsigned long def) {
+    if (!has(name)) return def;
+    string v = take(name);
+    char * end;
+    unsigned long x = strtoul(v.c_str(), &end, 10);
+    if (v.empty() || *end != '\0') {
+        fail("--" + name + " expects a non-negative integer: " + v);
+    }
+    return x;
+}
+
+double Options::take_double (string const & name, double def) {
+    if (!has(name)) return def;
+    string v = take(name);
+    char * end;
+    double x = strtod(v.c_str(), &end);
+    if (v.empty() || *end != '\0') {
+        fail("--" + name + " expects a number: " + v);
+    }
+    return x;
+}
+
+void Options::finish () const {
+    if (values.empty()) return;
+    fail("unknown option --" + values.begin()->first);
+}
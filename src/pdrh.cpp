@@ -0,0 +1,360 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// read a pdrh model in one pass: the top level is a sequence of comments,
+// #define lines, mode blocks in braces, and statements ending with ';'
+// outside any parentheses or brackets; a statement <kind>(...) <name>; of
+// a random variable kind is a declaration, wherever it starts and however
+// many lines it takes, and the statements after init: and goal: are states
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include "pdrh.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::ifstream;
+using std::ostringstream;
+using std::istringstream;
+using std::cerr;
+using std::endl;
+
+static bool identifier (char c) {
+    return isalnum(c) || c == '_';
+}
+
+static bool kind (string const & k) {
+    static const char * const kinds[] = {"B", "U", "N", "E", "DD", "jB", "jU", "jN", "jE"};
+    for (unsigned long j = 0; j < sizeof(kinds) / sizeof(kinds[0]); ++j) {
+        if (k == kinds[j]) return true;
+    }
+    return false;
+}
+
+// the statements of a text up to each ';' outside parentheses and brackets,
+// without the comments, each on one line, with the line it starts on; the
+// rest after the last ';' is left in rest
+static vector<std::pair<string, unsigned> > statements (string const & src, unsigned line, string & rest) {
+    vector<std::pair<string, unsigned> > all;
+    string stmt;
+    unsigned first = line;
+    bool blank = true;                  // nothing of the statement yet
+    int depth = 0;
+    for (unsigned long i = 0; i < src.size(); ++i) {
+        char c = src[i];
+        if (c == '/' && i + 1 < src.size() && src[i + 1] == '/') {
+            while (i + 1 < src.size() && src[i + 1] != '\n') i++;
+            continue;
+        }
+        if (blank) first = line;
+        if (!isspace(c)) blank = false;
+        if (c == '\n') {
+            line++;
+            stmt += ' ';
+        } else if (c == ';' && depth == 0) {
+            all.push_back(std::make_pair(trim(stmt), first));
+            stmt.clear();
+            blank = true;
+        } else {
+            if (c == '(' || c == '[') depth++;
+            if (c == ')' || c == ']') depth--;
+            stmt += (c == '\t' || c == '\r') ? ' ' : c;
+        }
+    }
+    rest = trim(stmt);
+    return all;
+}
+
+// the parts of a drh formula around its top-level commas, as in [lo, hi]
+static vector<string> split (string const & s) {
+    vector<string> parts;
+    int depth = 0;
+    string part;
+    for (unsigned long i = 0; i < s.size(); ++i) {
+        if (s[i] == '(' || s[i] == '[') depth++;
+        if (s[i] == ')' || s[i] == ']') depth--;
+        if (s[i] == ',' && depth == 0) {
+            parts.push_back(trim(part));
+            part.clear();
+        } else {
+            part += s[i];
+        }
+    }
+    parts.push_back(trim(part));
+    return parts;
+}
+
+// the section keyword a statement starts with, taken off it, if any
+static string section (string & stmt) {
+    unsigned long j = 0;
+    while (j < stmt.size() && identifier(stmt[j])) j++;
+    unsigned long k = j;
+    while (k < stmt.size() && (stmt[k] == ' ')) k++;
+    if (j == 0 || k >= stmt.size() || stmt[k] != ':') return "";
+    string word = stmt.substr(0, j);
+    if (word != "invt" && word != "flow" && word != "jump" && word != "time" && word != "init" && word != "goal") return "";
+    stmt = trim(stmt.substr(k + 1));
+    return word;
+}
+
+// @<mode> <formula>
+static bool state (string const & stmt, State & s) {
+    if (stmt.empty() || stmt[0] != '@') return false;
+    char * end;
+    s.mode = strtol(stmt.c_str() + 1, &end, 10);
+    if (end == stmt.c_str() + 1) return false;
+    s.formula = trim(end);
+    return true;
+}
+
+void PdrhModel::fail (unsigned line, string const & why) const {
+    ::fail(file + ":" + std::to_string(line) + ": " + why);
+}
+
+void PdrhModel::mode (string const & body, unsigned line) {
+    Mode m;
+    m.id = -1;
+    string rest, part;
+    vector<std::pair<string, unsigned> > all = statements(body, line, rest);
+    for (unsigned long s = 0; s < all.size(); ++s) {
+        string stmt = all[s].first;
+        string word;
+        while (!(word = section(stmt)).empty()) part = word;
+        if (stmt.empty()) continue;
+        if (part.empty() && stmt.compare(0, 4, "mode") == 0 && stmt.size() > 4 && !identifier(stmt[4])) {
+            char * end;
+            string id = trim(stmt.substr(4));
+            m.id = strtol(id.c_str(), &end, 10);
+            if (id.empty() || *end != '\0') fail(all[s].second, "bad mode number: " + stmt);
+        } else if (part == "invt") {
+            m.invariants.push_back(stmt);
+        } else if (part == "flow") {
+            m.flows.push_back(stmt);
+        } else if (part == "jump") {
+            Jump j;
+            size_t arrow = stmt.find("==>");
+            State to;
+            if (arrow == string::npos || !state(trim(stmt.substr(arrow + 3)), to)) {
+                fail(all[s].second, "a jump must be <guard> ==> @<mode> <reset>: " + stmt);
+            }
+            j.guard = trim(stmt.substr(0, arrow));
+            j.target = to.mode;
+            j.reset = to.formula;
+            m.jumps.push_back(j);
+        } else if (part != "time") {
+            fail(all[s].second, "unexpected statement in a mode: " + stmt);
+        }
+    }
+    // only section keywords may follow the last ';'
+    while (!section(rest).empty()) {}
+    if (!rest.empty()) fail(line, "missing ';' in a mode: " + rest);
+    if (m.id < 0) fail(line, "a mode block without mode <n>;");
+    blocks.push_back(m);
+}
+
+PdrhModel::PdrhModel (string const & pdrhfile) : file(pdrhfile) {
+
+    ifstream in(pdrhfile.c_str(), std::ios::binary);
+    if (!in.is_open()) ::fail("cannot open the pdrh model", pdrhfile);
+    ostringstream contents;
+    contents << in.rdbuf();
+    string const src = contents.str();
+    unsigned long n = src.size();
+    text.reserve(n);
+
+    string part = "";                   // init or goal once they begin
+    unsigned line = 1;
+    unsigned long i = 0;
+    unsigned long kept = 0;             // src is copied into the drh model up to here
+    while (i < n) {
+        char c = src[i];
+        if (c == '\n') {
+            line++;
+            i++;
+            continue;
+        }
+        if (isspace(c)) {
+            i++;
+            continue;
+        }
+        // a comment, or a #define line, to the end of the line
+        if ((c == '/' && i + 1 < n && src[i + 1] == '/') || c == '#') {
+            unsigned long eol = src.find('\n', i);
+            if (eol == string::npos) eol = n;
+            if (c == '#') {
+                istringstream directive(src.substr(i, eol - i));
+                string word, name;
+                directive >> word >> name;
+                if (word == "#define" && !name.empty()) defs.push_back(name);
+            }
+            i = eol;
+            continue;
+        }
+        // a mode block, to the matching brace
+        if (c == '{') {
+            unsigned first = line;
+            unsigned long j = i + 1;
+            for (; j < n && src[j] != '}'; ++j) {
+                if (src[j] == '/' && j + 1 < n && src[j + 1] == '/') {
+                    while (j + 1 < n && src[j + 1] != '\n') j++;
+                } else if (src[j] == '{') {
+                    fail(line, "a mode block inside another one");
+                } else if (src[j] == '\n') {
+                    line++;
+                }
+            }
+            if (j == n) fail(first, "a mode block without its closing brace");
+            mode(src.substr(i + 1, j - i - 1), first);
+            i = j + 1;
+            continue;
+        }
+        if (c == '}') fail(line, "a closing brace without its mode block");
+
+        // a statement, to the ';' outside any parentheses or brackets
+        unsigned long start = i;
+        unsigned first = line;
+        int depth = 0;
+        string stmt;
+        for (; i < n && !(src[i] == ';' && depth == 0); ++i) {
+            if (src[i] == '/' && i + 1 < n && src[i + 1] == '/') {
+                while (i + 1 < n && src[i + 1] != '\n') i++;
+                continue;
+            }
+            if (src[i] == '\n') line++;
+            if (src[i] == '(' || src[i] == '[') depth++;
+            if (src[i] == ')' || src[i] == ']') depth--;
+            if (src[i] == '{' || src[i] == '}') break;
+            // init: and goal: start their sections without a ';'
+            if (src[i] == ':' && depth == 0) {
+                string head = trim(stmt);
+                if (head == "init" || head == "goal") break;
+            }
+            stmt += isspace(src[i]) ? ' ' : src[i];
+        }
+        stmt = trim(stmt);
+        if (i < n && src[i] == ':') {
+            part = stmt;
+            i++;
+            continue;
+        }
+        if (i == n || src[i] != ';') fail(first, "missing ';' after: " + stmt);
+        i++;
+        if (stmt.empty()) continue;
+
+        if (!part.empty()) {
+            State s;
+            if (!state(stmt, s)) fail(first, "a state of " + part + " must be @<mode> <formula>: " + stmt);
+            (part == "init" ? inits : goals).push_back(s);
+            continue;
+        }
+        if (stmt[0] == '[') {
+            size_t close = stmt.find(']');
+            Bound b;
+            vector<string> range = (close == string::npos) ? vector<string>() : split(stmt.substr(1, close - 1));
+            if (range.empty() || range.size() > 2) fail(first, "a variable must be [lo, hi] name; or [value] name;: " + stmt);
+            b.lo = range[0];
+            b.hi = range.back();
+            b.name = trim(stmt.substr(close + 1));
+            vars.push_back(b);
+            continue;
+        }
+        unsigned long k = 0;
+        while (k < stmt.size() && identifier(stmt[k])) k++;
+        unsigned long open = k;
+        while (open < stmt.size() && stmt[open] == ' ') open++;
+        if (open == stmt.size() || stmt[open] != '(' || !kind(stmt.substr(0, k))) continue;
+
+        Declaration d;
+        d.kind = stmt.substr(0, k);
+        d.text = stmt + ";";
+        d.line = first;
+        size_t close = stmt.rfind(')');
+        d.name = (close == string::npos) ? "" : trim(stmt.substr(close + 1));
+        decls.push_back(d);
+
+        // the declaration leaves the drh model, with its lines if it has
+        // them to itself, a comment after it included
+        unsigned long from = start, to = i;
+        unsigned long bol = src.find_last_of('\n', start);
+        bol = std::max((bol == string::npos) ? 0 : bol + 1, kept);
+        unsigned long after = to;
+        while (after < n && (src[after] == ' ' || src[after] == '\t' || src[after] == '\r')) after++;
+        if (after + 1 < n && src[after] == '/' && src[after + 1] == '/') {
+            while (after < n && src[after] != '\n') after++;
+        }
+        if (src.find_first_not_of(" \t", bol) == start && (after == n || src[after] == '\n')) {
+            from = bol;
+            to = (after == n) ? n : after + 1;
+            if (after < n) line++;
+        }
+        text.append(src, kept, from - kept);
+        kept = to;
+        i = to;
+    }
+    text.append(src, kept, n - kept);
+
+    // the dependency graph, by the names in the parameters
+    map<string, int> names;
+    for (unsigned long d = 0; d < decls.size(); ++d) names[decls[d].name] = d;
+    for (unsigned long d = 0; d < decls.size(); ++d) {
+        string const & t = decls[d].text;
+        size_t open = t.find('('), close = t.rfind(')');
+        for (size_t j = open + 1; j < close; ) {
+            if (!(isalpha(t[j]) || t[j] == '_') || (j > 0 && (identifier(t[j - 1]) || t[j - 1] == '.'))) {
+                j++;
+                continue;
+            }
+            size_t e = j;
+            while (e < close && identifier(t[e])) e++;
+            map<string, int>::const_iterator it = names.find(t.substr(j, e - j));
+            if (it != names.end() && it->second != int(d)) {
+                vector<int> & deps = decls[d].deps;
+                if (std::find(deps.begin(), deps.end(), it->second) == deps.end()) deps.push_back(it->second);
+            }
+            j = e;
+        }
+    }
+}
+
+vector<string> PdrhModel::distributions () const {
+    vector<string> all;
+    for (unsigned long d = 0; d < decls.size(); ++d) all.push_back(decls[d].text);
+    return all;
+}
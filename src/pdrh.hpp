@@ -0,0 +1,120 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+
+// a random variable declaration: <kind>(<parameters>) <name>;
+struct Declaration {
+    std::string kind;                   // B, U, N, E or DD, with a leading j for a jump random variable
+    std::string name;
+    std::string text;                   // the declaration on one line, for RVProgram
+    unsigned line;                      // where it starts in the pdrh file
+    std::vector<int> deps;              // the declarations its parameters refer to
+};
+
+// a variable of the drh model and its range: [lo, hi] name; or [value] name;
+struct Bound {
+    std::string name;
+    std::string lo, hi;
+};
+
+// a jump of a mode: <guard> ==> @<target> <reset>;
+struct Jump {
+    std::string guard;
+    int target;
+    std::string reset;
+};
+
+// a mode block: { mode <id>; invt: ...; flow: ...; jump: ...; }
+struct Mode {
+    int id;
+    std::vector<std::string> invariants;
+    std::vector<std::string> flows;     // d/dt[x] = ...
+    std::vector<Jump> jumps;
+};
+
+// a state of init: or goal: @<mode> <formula>;
+struct State {
+    int mode;
+    std::string formula;
+};
+
+// a pdrh model read in one pass: the random variable declarations, found
+// as statements wherever they start and however many lines they take, and
+// the drh model around them, kept in memory with its parts parsed out; it
+// is not changed once read, so the workers share it
+class PdrhModel {
+private:
+    std::string file;
+    std::string text;                   // the drh model: the pdrh model without the declarations
+    std::vector<Declaration> decls;
+    std::vector<std::string> defs;      // the names of the #define lines
+    std::vector<Bound> vars;
+    std::vector<Mode> blocks;
+    std::vector<State> inits, goals;
+
+    void fail (unsigned line, std::string const & why) const;
+    void mode (std::string const & body, unsigned line);
+
+public:
+    // read and parse the pdrh file
+    PdrhModel (std::string const & pdrhfile);
+
+    // the drh model, as dReach reads it once the random variables have values
+    std::string const & drh () const {
+        return text;
+    }
+
+    // the declarations of the random variables, in the order of the file
+    std::vector<Declaration> const & declarations () const {
+        return decls;
+    }
+
+    // their text, one per line, as RVProgram compiles them
+    std::vector<std::string> distributions () const;
+
+    std::vector<std::string> const & defines () const {
+        return defs;
+    }
+    std::vector<Bound> const & bounds () const {
+        return vars;
+    }
+    std::vector<Mode> const & modes () const {
+        return blocks;
+    }
+    std::vector<State> const & init () const {
+        return inits;
+    }
+    std::vector<State> const & goal () const {
+        return goals;
+    }
+};
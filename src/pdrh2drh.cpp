@@ -31,49 +31,30 @@
 
 
 
-
-//read in a pdrh file
-//output a string vector containing all random variables and their corresponding
-//distributions, and a corresponding drh file
+// read in a pdrh file
+// output a string vector containing all random variables and their corresponding
+// distributions, and a corresponding drh file
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
+#include <cstdlib>
+#include "pdrh.hpp"
 #include "pdrh2drh.hpp"
+#include "util.hpp"
 
 using std::string;
-using std::ifstream;
 using std::ofstream;
-using std::cout;
+using std::cerr;
 using std::endl;
 using std::vector;
 
-vector<string> pdrh2drh (string const & modelfile) {
-  string line;
-  ifstream myfile1 (modelfile);
-  vector<string> myfile2;
-  ofstream myfile3 ("model_w_define.drh");
-  if (myfile1.is_open())
-  {
-    while (getline (myfile1, line))
-    {
-
-      string str = line.substr(0, 2);
-      string str2 = line.substr(0, 3);
-      if (str == "B(" || str =="N(" || str =="U(" || str =="E(" || str2 == "DD(" || str2 == "jB(" || str2 == "jN(" || str2 == "jU(" || str2 == "jE(")
-      {
-          myfile2.push_back(line);
-      }
-      else{
-        myfile3 << line << '\n';
-      }
+vector<string> pdrh2drh (string const & modelfile, string const & drhfile) {
+    PdrhModel model(modelfile);
+    ofstream drh(drhfile.c_str(), std::ios::binary);
+    if (!drh.is_open()) {
+        fail("cannot write the drh model: " + drhfile);
     }
-    myfile1.close();
-    myfile3.close();
-  }
-  else {
-      cout << "Unable to open the given pdrh model file";
-      exit (EXIT_FAILURE);
-  }
-    return myfile2;
+    drh << model.drh();
+    return model.distributions();
 }
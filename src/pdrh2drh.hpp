@@ -31,4 +31,6 @@
 #pragma once
 #include <string>
 #include <vector>
-std::vector<std::string> pdrh2drh (std::string const & modelfile);
+// write the drh part of the pdrh model to drhfile, and return the
+// declarations of its random variables
+std::vector<std::string> pdrh2drh (std::string const & modelfile, std::string const & drhfile = "model_w_define.drh");
@@ -0,0 +1,93 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include "prefetch.hpp"
+
+using std::vector;
+
+Prefetch::Prefetch (Sampler const & s, WorkQueue const & w, unsigned long n, unsigned long batches)
+    : sampler(s), work(w), size(n), ring(batches), held(batches, ULONG_MAX), stopped(false) {
+}
+
+void Prefetch::run () {
+
+    unsigned long next = 0;             // the number of the next batch
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;) {
+        // no further ahead than the ring, nor past the limit; the batches
+        // the workers have passed already are not drawn at all
+        for (;;) {
+            if (stopped) return;
+            unsigned long front = work.front() / size;
+            next = std::max(next, front);
+            if (next < front + ring.size() && next * size < work.ceiling()) break;
+            wakeup.wait_for(guard, std::chrono::milliseconds(10));
+        }
+
+        guard.unlock();
+        Batch batch;
+        sampler.sample(next * size, size, batch);
+        guard.lock();
+
+        unsigned long slot = next % ring.size();
+        std::swap(ring[slot], batch);
+        held[slot] = next;
+        next++;
+    }
+}
+
+void Prefetch::stop () {
+    std::lock_guard<std::mutex> guard(lock);
+    stopped = true;
+    wakeup.notify_all();
+}
+
+bool Prefetch::take (unsigned long index, vector<double> & values, double & weight, Rng & rng) {
+
+    std::lock_guard<std::mutex> guard(lock);
+    // the front has moved on
+    wakeup.notify_one();
+    unsigned long slot = (index / size) % ring.size();
+    if (held[slot] != index / size) return false;
+
+    Batch const & batch = ring[slot];
+    unsigned long j = index - batch.first;
+    values.resize(batch.columns.size() / size);
+    for (unsigned long i = 0; i < values.size(); ++i) values[i] = batch.columns[i * size + j];
+    weight = batch.weights[j];
+    rng = batch.rngs[j];
+    return true;
+}
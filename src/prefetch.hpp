@@ -0,0 +1,68 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "rng.hpp"
+#include "sampler.hpp"
+#include "scheduler.hpp"
+
+// the sampling stage of sreach_para: a thread of its own draws the
+// samples in batches, by column, a few batches ahead of the indices the
+// work queue hands out, into a ring; a worker then takes its sample ready
+// drawn. it never waits for the stage: a sample not drawn yet, or dropped
+// already (an index handed out again), it draws itself, and it is the same
+// sample either way
+class Prefetch {
+private:
+    Sampler const & sampler;
+    WorkQueue const & work;
+    unsigned long size;                 // samples per batch
+    std::vector<Batch> ring;
+    std::vector<unsigned long> held;    // the batch in each slot, by number, ULONG_MAX for none
+    bool stopped;
+    std::mutex lock;
+    std::condition_variable wakeup;     // the stage, waiting for the workers to move on
+
+public:
+    // batches of size samples, up to batches of them ahead
+    Prefetch (Sampler const & sampler, WorkQueue const & work, unsigned long size, unsigned long batches);
+
+    // draw the batches, until stop()
+    void run ();
+
+    void stop ();
+
+    // the sample of the index, its weight and its stream past the draw;
+    // false when it is not drawn
+    bool take (unsigned long index, std::vector<double> & values, double & weight, Rng & rng);
+};
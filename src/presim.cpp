@@ -37,27 +37,21 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <random>
 #include <boost/regex.hpp>
 #include "presim.hpp"
 #include <cstdlib>
 #include <vector>
 #include <sstream>
 
-using std::bernoulli_distribution;
 using std::cout;
-using std::default_random_engine;
 using std::endl;
-using std::exponential_distribution;
 using std::ifstream;
-using std::normal_distribution;
 using std::ofstream;
 using std::string;
-using std::uniform_real_distribution;
 using std::ostringstream;
 using std::vector;
 
-vector<string> presim (vector<string> & distrfile){
+vector<string> presim (vector<string> & distrfile, Rng & rng){
 
   vector<string> assignfile;
 
@@ -93,10 +87,7 @@ vector<string> presim (vector<string> & distrfile){
                   //parameter for the bernoulli distribution
                   double para = atof(paraStr.c_str());
 
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  bernoulli_distribution distribution(para);
-                  double x = double(distribution(generator));
+                  double x = double(rng.bernoulli(para));
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -123,10 +114,7 @@ vector<string> presim (vector<string> & distrfile){
               if (boost::regex_match(line2.c_str(), matches, re)) {
                   string paraStr = string() + matches[4];
                   double para = atof(paraStr.c_str());
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  exponential_distribution<double> distribution(para);
-                  double x = distribution(generator);
+                  double x = rng.exponential(para);
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -156,10 +144,7 @@ vector<string> presim (vector<string> & distrfile){
                   double para1 = atof(paraStr1.c_str());
                   string paraStr2 = string() + matches[8];
                   double para2 =atof(paraStr2.c_str());
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  uniform_real_distribution<double> distribution(para1, para2);
-                  double x = distribution(generator);
+                  double x = rng.uniform(para1, para2);
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -188,10 +173,7 @@ vector<string> presim (vector<string> & distrfile){
                   double para1 = atof(paraStr1.c_str());
                   string paraStr2 = string() + matches[8];
                   double para2 =atof(paraStr2.c_str());
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  normal_distribution<double> distribution(para1, para2);
-                  double x = distribution(generator);
+                  double x = rng.normal(para1, para2);
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -0,0 +1,167 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// the certified unsat boxes of the parameter space
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "regioncache.hpp"
+
+using std::vector;
+
+RegionCache::RegionCache (RVProgram const & rvprog, double size) :
+    scale(rvprog.size(), 0),
+    lower(rvprog.size(), -std::numeric_limits<double>::infinity()),
+    upper(rvprog.size(), std::numeric_limits<double>::infinity()),
+    largest(size), current(size) {
+
+    for (unsigned long i = 0; i < rvprog.size(); ++i) {
+        RandomVar const & rv = rvprog.var(rvprog.find(rvprog.name(i)));
+        bool constant = true;
+        for (unsigned long p = 0; p < rv.params.size(); ++p) constant = constant && rv.params[p].constant();
+        // parameters drawn from the jump random variables move the support
+        if (!constant) continue;
+        switch (rv.kind) {
+        case RandomVar::UNIFORM:
+            lower[i] = rv.params[0].value;
+            upper[i] = rv.params[1].value;
+            scale[i] = upper[i] - lower[i];
+            break;
+        case RandomVar::NORMAL:
+            scale[i] = 6 * rv.params[1].value;
+            break;
+        case RandomVar::EXPONENTIAL:
+            lower[i] = 0;
+            scale[i] = 6 / rv.params[0].value;
+            break;
+        default:
+            break;
+        }
+        if (!(scale[i] > 0) || std::isinf(scale[i])) scale[i] = 0;
+    }
+}
+
+vector<double> RegionCache::rounded (vector<double> const & assignment) {
+    // the value in the point model, as RVProgram::format() prints it
+    vector<double> x(assignment.size());
+    char text[32];
+    for (unsigned long i = 0; i < assignment.size(); ++i) {
+        snprintf(text, sizeof(text), "%g", assignment[i]);
+        x[i] = strtod(text, NULL);
+    }
+    return x;
+}
+
+bool RegionCache::inside (vector<double> const & x, vector<double> const & lo, vector<double> const & hi) {
+    for (unsigned long i = 0; i < x.size(); ++i) {
+        if (x[i] < lo[i] || x[i] > hi[i]) return false;
+    }
+    return true;
+}
+
+bool RegionCache::covered (vector<double> const & assignment) const {
+    vector<double> x = rounded(assignment);
+    std::lock_guard<std::mutex> guard(lock);
+    if (nodes.empty()) return false;
+    vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        Node const & n = nodes[stack.back()];
+        stack.pop_back();
+        if (!inside(x, n.low, n.high)) continue;
+        if (inside(x, n.lo, n.hi)) return true;
+        if (n.left >= 0) stack.push_back(n.left);
+        if (n.right >= 0) stack.push_back(n.right);
+    }
+    return false;
+}
+
+bool RegionCache::around (vector<double> const & assignment, vector<double> & lo, vector<double> & hi) const {
+    vector<double> x = rounded(assignment);
+    double size;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        size = current;
+    }
+    lo = x;
+    hi = x;
+    bool continuous = false;
+    for (unsigned long i = 0; i < x.size(); ++i) {
+        if (scale[i] == 0) continue;
+        double w = size * scale[i] / 2;
+        lo[i] = std::min(x[i], std::max(lower[i], x[i] - w));
+        hi[i] = std::max(x[i], std::min(upper[i], x[i] + w));
+        continuous = continuous || lo[i] < hi[i];
+    }
+    return continuous;
+}
+
+void RegionCache::certified (vector<double> const & lo, vector<double> const & hi, bool unsat) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!unsat) {
+        current = std::max(current / 2, largest / 64);
+        return;
+    }
+    current = std::min(current * 2, largest);
+
+    Node node;
+    node.lo = lo;
+    node.hi = hi;
+    node.low = lo;
+    node.high = hi;
+    node.left = node.right = -1;
+    int index = nodes.size();
+    nodes.push_back(node);
+    if (index == 0) return;
+
+    // descend by the lower corner, one dimension per level,
+    // widening the bounds of every subtree on the way
+    int at = 0;
+    for (unsigned long depth = 0; ; ++depth) {
+        Node & n = nodes[at];
+        for (unsigned long i = 0; i < lo.size(); ++i) {
+            n.low[i] = std::min(n.low[i], lo[i]);
+            n.high[i] = std::max(n.high[i], hi[i]);
+        }
+        unsigned long d = depth % std::max(lo.size(), 1UL);
+        int & child = (lo.empty() || lo[d] < n.lo[d]) ? n.left : n.right;
+        if (child < 0) {
+            child = index;
+            return;
+        }
+        at = child;
+    }
+}
+
+unsigned long RegionCache::size () const {
+    std::lock_guard<std::mutex> guard(lock);
+    return nodes.size();
+}
@@ -0,0 +1,81 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <vector>
+#include <mutex>
+#include "rvprog.hpp"
+
+// boxes of the parameter space that dReach certified unsat as a whole,
+// indexed by a k-d tree on their lower corners, every node keeping the
+// bounds of its subtree for pruning.  a sample inside a box is unsat
+// without a dReach run: the box model, with each random variable of the
+// box a parameter ranging over it, over-approximates every point model
+// in the box.  only unsat is certified this way, since a delta-sat box
+// model says nothing about its other points
+class RegionCache {
+public:
+    // size is the width of a new box, as a fraction of the range of each
+    // continuous random variable (a sixth of it for the unbounded ones)
+    RegionCache (RVProgram const & rvprog, double size);
+
+    // whether a certified box holds the assignment, as the drh model gets it
+    bool covered (std::vector<double> const & assignment) const;
+
+    // the box to check around an unsat assignment not yet covered;
+    // false if no random variable of the drh model is continuous
+    bool around (std::vector<double> const & assignment, std::vector<double> & lo,
+                 std::vector<double> & hi) const;
+
+    // record the verdict of a box from around(): unsat boxes are added,
+    // and the boxes to come grow after a success and shrink after a failure
+    void certified (std::vector<double> const & lo, std::vector<double> const & hi, bool unsat);
+
+    // number of certified boxes
+    unsigned long size () const;
+
+private:
+    struct Node {
+        std::vector<double> lo, hi;     // the box
+        std::vector<double> low, high;  // the bounds of the boxes of the subtree
+        int left, right;                // children, -1 for none
+    };
+
+    std::vector<double> scale;          // the range of each variable, 0 for discrete ones
+    std::vector<double> lower, upper;   // its support
+    double largest;                     // the initial size
+    double current;                     // the size of the next box
+    std::vector<Node> nodes;            // nodes[0] is the root
+    mutable std::mutex lock;
+
+    static std::vector<double> rounded (std::vector<double> const & assignment);
+    static bool inside (std::vector<double> const & x, std::vector<double> const & lo,
+                        std::vector<double> const & hi);
+};
@@ -0,0 +1,272 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// the coordinator and the worker ends of distributed runs
+// every message is a length (network order) followed by that many bytes,
+// a model (followed by the precision for it) or a string; every reply to a
+// model is a verdict (network order)
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <exception>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "remote.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::ofstream;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// sent by a worker first, so that stray connections are turned away
+static const char HELLO[8] = {'s', 'r', 'e', 'a', 'c', 'h', 'w', '2'};
+
+static bool sendstr (int fd, string const & s) {
+    uint32_t len = htonl(s.size());
+    return writeall(fd, &len, sizeof(len)) && writeall(fd, s.data(), s.size());
+}
+
+static bool recvstr (int fd, string & s) {
+    uint32_t len;
+    if (!readall(fd, &len, sizeof(len))) return false;
+    s.assign(ntohl(len), '\0');
+    return s.empty() || readall(fd, &s[0], s.size());
+}
+
+// the messages are small and every one waits for its reply
+static void nodelay (int fd) {
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+RemoteSolver::RemoteSolver (int fd, string const & address) : channel(fd), peer(address) {
+}
+
+RemoteSolver::~RemoteSolver () {
+    // an empty model asks the worker to exit
+    sendstr(channel, "");
+    close(channel);
+}
+
+int RemoteSolver::solve_piped (string const & model, string const & delta, int lower, int upper) {
+    uint32_t result;
+    std::ostringstream depths;
+    depths << lower << " " << upper;
+    if (model.empty() || !sendstr(channel, model) || !sendstr(channel, delta) || !sendstr(channel, depths.str())
+        || !readall(channel, &result, sizeof(result))) {
+        return LOST;
+    }
+    result = ntohl(result);
+    if (result == static_cast<uint32_t>(Solver::UNKNOWN)) return Solver::UNKNOWN;
+    return (result == static_cast<uint32_t>(Solver::SAT)) ? Solver::SAT : Solver::UNSAT;
+}
+
+void RemoteSolver::stop () {
+    shutdown(channel, SHUT_RDWR);
+}
+
+vector<RemoteSolver *> accept_workers (unsigned long port, unsigned long n, string const & k, string const & delta,
+                                       double seconds, unsigned long megabytes) {
+
+    std::ostringstream limits;
+    limits.precision(17);
+    limits << seconds << " " << megabytes;
+
+    int server = socket(AF_INET6, SOCK_STREAM, 0);
+    bool v6 = (server >= 0);
+    if (!v6) server = socket(AF_INET, SOCK_STREAM, 0);
+    if (server < 0) {
+        fail("cannot create the socket for the remote workers");
+    }
+    int on = 1, off = 0;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    int bound;
+    if (v6) {
+        // accept IPv4 workers on the same socket
+        setsockopt(server, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        struct sockaddr_in6 addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        addr.sin6_addr = in6addr_any;
+        addr.sin6_port = htons(port);
+        bound = bind(server, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    } else {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        bound = bind(server, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    }
+    if (bound != 0 || listen(server, n) != 0) {
+        fail("cannot listen for the remote workers on port " + std::to_string(port));
+    }
+
+    cout << "Waiting for " << n << " remote workers on port " << port << endl;
+    vector<RemoteSolver *> workers;
+    while (workers.size() < n) {
+        struct sockaddr_storage addr;
+        socklen_t addrlen = sizeof(addr);
+        int fd = accept(server, reinterpret_cast<struct sockaddr *>(&addr), &addrlen);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            fail("cannot accept the remote workers");
+        }
+        nodelay(fd);
+
+        char host[NI_MAXHOST] = "?";
+        getnameinfo(reinterpret_cast<struct sockaddr *>(&addr), addrlen, host, sizeof(host), NULL, 0, NI_NUMERICHOST);
+
+        char hello[sizeof(HELLO)];
+        if (!readall(fd, hello, sizeof(hello)) || memcmp(hello, HELLO, sizeof(HELLO)) != 0
+            || !sendstr(fd, k) || !sendstr(fd, delta) || !sendstr(fd, limits.str())) {
+            cerr << "Warning: turned away a connection from " << host << endl;
+            close(fd);
+            continue;
+        }
+        workers.push_back(new RemoteSolver(fd, host));
+        cout << "Remote worker " << workers.size() << " connected from " << host << endl;
+    }
+    close(server);
+    return workers;
+}
+
+void serve_coordinator (string const & host, unsigned long port, string const & dreach, bool piped) {
+
+    struct addrinfo hints, * found;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &found) != 0) {
+        fail("cannot resolve the coordinator: " + host);
+    }
+    int fd = -1;
+    for (struct addrinfo * a = found; a != NULL && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd < 0) {
+        fail("cannot connect to the coordinator: " + host + ":" + std::to_string(port));
+    }
+    nodelay(fd);
+
+    string k, delta, limits;
+    if (!writeall(fd, HELLO, sizeof(HELLO)) || !recvstr(fd, k) || !recvstr(fd, delta) || !recvstr(fd, limits)) {
+        fail("the coordinator did not accept this worker");
+    }
+    double seconds = 0;
+    unsigned long megabytes = 0;
+    std::istringstream(limits) >> seconds >> megabytes;
+    cout << "Connected to " << host << ":" << port << ", k = " << k << ", delta = " << delta << endl;
+
+    Solver solver(dreach, k, delta, piped, seconds, megabytes);
+    string drhname = "numodel_" + std::to_string(getpid());
+    string model, coarser, depths;
+    unsigned long checked = 0;
+
+    // wakes the watcher up when a solve is over
+    int wake[2];
+    if (pipe(wake) != 0) {
+        fail("cannot create the pipe of the worker");
+    }
+
+    while (recvstr(fd, model) && !model.empty() && recvstr(fd, coarser) && recvstr(fd, depths)) {
+        int lower = 0, upper = -1;
+        std::istringstream(depths) >> lower >> upper;
+
+        // the coordinator sends nothing while a model is checked, unless
+        // it stops this worker because every test is done
+        std::thread watcher([&] () {
+            struct pollfd watched[2] = {{fd, POLLIN, 0}, {wake[0], POLLIN, 0}};
+            while (poll(watched, 2, -1) < 0 && errno == EINTR);
+            if (watched[0].revents != 0) solver.cancel();
+        });
+
+        // the watcher is stopped before an error of the solve goes on
+        int result = Solver::UNKNOWN;
+        std::exception_ptr failure;
+        try {
+            if (piped) {
+                result = solver.solve_piped(model, coarser, lower, upper);
+            } else {
+                ofstream nudrhfile (drhname + ".drh", std::ios::binary);
+                nudrhfile.write(model.data(), model.size());
+                nudrhfile.close();
+                result = solver.solve(drhname, coarser, lower, upper);
+            }
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        char done = 0;
+        ssize_t woken = write(wake[1], &done, 1);
+        watcher.join();
+        if (failure) std::rethrow_exception(failure);
+        if (woken != 1 || read(wake[0], &done, 1) != 1) {
+            fail("cannot stop the watcher of the worker");
+        }
+        if (result == Solver::CANCELLED) break;
+        checked++;
+        uint32_t reply = htonl(result);
+        if (!writeall(fd, &reply, sizeof(reply))) break;
+    }
+    close(wake[0]);
+    close(wake[1]);
+    close(fd);
+    cout << "Checked " << checked << " models" << endl;
+}
@@ -0,0 +1,71 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include "solver.hpp"
+
+// a sreach_worker on another node, connected to the coordinator over TCP
+// the coordinator keeps the tests and the sample cache, samples and
+// instantiates the models itself, and only ships the model text out;
+// the worker answers with sat or unsat
+class RemoteSolver {
+private:
+    int channel;                // connection to the worker
+    std::string peer;           // address of the worker, for messages
+
+public:
+    static const int LOST = -1;
+
+    RemoteSolver (int fd, std::string const & address);
+    ~RemoteSolver ();
+
+    // check the model text on the worker, at the given precision and
+    // unfolding steps if any, as Solver::solve_piped(); SAT, UNSAT, UNKNOWN
+    // when the run hit the limits of the worker, or LOST when the worker
+    // is gone or the coordinator stopped it
+    int solve_piped (std::string const & model, std::string const & delta = "", int lower = 0, int upper = -1);
+
+    // stop the worker, a solve waiting for it returns LOST at once
+    void stop ();
+
+    std::string const & address () const { return peer; }
+};
+
+// wait on the port for n workers and send each the unfolding steps, the
+// precision, and the time and memory limits they run dReach with
+std::vector<RemoteSolver *> accept_workers (unsigned long port, unsigned long n,
+                                            std::string const & k, std::string const & delta,
+                                            double seconds, unsigned long megabytes);
+
+// the worker side: connect to the coordinator and check the models it
+// sends with the dReach given, until the coordinator stops
+void serve_coordinator (std::string const & host, unsigned long port, std::string const & dreach, bool piped);
@@ -37,6 +37,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/tokenizer.hpp>
 #include "replace.hpp"
+#include "util.hpp"
 #include <cstdlib>
 
 
@@ -101,8 +102,7 @@ void replace (string const & olddrhfile, vector<string> & simresf){
         }
         drhfile.close();
     }else{
-      cout << "Unable to open the drh model file. " << endl;
-      exit (EXIT_FAILURE);
+      fail("cannot open the drh model file");
   }
 
   nudrhfile.close();
@@ -150,8 +150,7 @@ void replace (string const & olddrhfile, vector<string> & simresf, int tid){
         }
         drhfile.close();
     }else{
-        cout << "Unable to open the drh model file. " << endl;
-        exit (EXIT_FAILURE);
+        fail("cannot open the drh model file");
     }
     
     nudrhfile.close();
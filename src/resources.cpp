@@ -0,0 +1,221 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <sched.h>
+#include <unistd.h>
+#include "resources.hpp"
+
+using std::string;
+using std::vector;
+using std::ifstream;
+using std::istringstream;
+using std::ostringstream;
+
+// the kernel writes a limit of "none" as the largest page-aligned long
+static const unsigned long UNLIMITED = 1UL << 62;
+
+static string first (string const & file) {
+    ifstream in(file.c_str());
+    string line;
+    getline(in, line);
+    return line;
+}
+
+static bool exists (string const & file) {
+    return access(file.c_str(), R_OK) == 0;
+}
+
+// a list of processors as the kernel prints it: 0-3,8,10-11
+static vector<int> cpulist (string const & text) {
+    vector<int> cpus;
+    istringstream in(text);
+    string range;
+    while (getline(in, range, ',')) {
+        int lo, hi;
+        int n = sscanf(range.c_str(), "%d-%d", &lo, &hi);
+        if (n == 1) hi = lo;
+        if (n < 1) continue;
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+// the value of a key of a memory.stat file, 0 when not there
+static unsigned long statvalue (string const & file, string const & key) {
+    ifstream in(file.c_str());
+    string k;
+    unsigned long v;
+    while (in >> k >> v) {
+        if (k == key) return v;
+    }
+    return 0;
+}
+
+// the directories of the cgroup of a controller, from the cgroup of the
+// process up to the root of its mount: a limit anywhere on the way applies
+static vector<string> hierarchy (string const & root, string const & path) {
+    vector<string> dirs;
+    string p = path;
+    for (;;) {
+        if (exists(root + p)) dirs.push_back(root + p);
+        if (p.empty() || p == "/") break;
+        p = p.substr(0, p.find_last_of('/'));
+    }
+    return dirs;
+}
+
+Resources::Resources () : quota(0), limit(0) {
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) allowed.push_back(c);
+        }
+    }
+#endif
+    if (allowed.empty()) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long c = 0; c < std::max(n, 1L); ++c) allowed.push_back(c);
+    }
+
+    // the nodes, with the processors of the affinity mask only
+    for (int node = 0; ; ++node) {
+        string file = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        if (!exists(file)) break;
+        vector<int> cpus = cpulist(first(file)), mine;
+        for (unsigned long j = 0; j < cpus.size(); ++j) {
+            if (std::find(allowed.begin(), allowed.end(), cpus[j]) != allowed.end()) mine.push_back(cpus[j]);
+        }
+        if (!mine.empty()) numa.push_back(mine);
+    }
+
+    // the cgroup of each controller: 0::<path> for v2, <id>:<controllers>:<path> for v1
+    string unified, cpupath, mempath;
+    bool v1cpu = false, v1mem = false;
+    ifstream groups("/proc/self/cgroup");
+    string line;
+    while (getline(groups, line)) {
+        string::size_type a = line.find(':'), b = line.find(':', a + 1);
+        if (a == string::npos || b == string::npos) continue;
+        string controllers = "," + line.substr(a + 1, b - a - 1) + ",";
+        string path = line.substr(b + 1);
+        if (controllers == ",,") unified = path;
+        if (controllers.find(",cpu,") != string::npos) { cpupath = path; v1cpu = true; }
+        if (controllers.find(",memory,") != string::npos) { mempath = path; v1mem = true; }
+    }
+
+    // the smallest quota and limit on the way up
+    vector<string> dirs = v1cpu ? hierarchy(exists("/sys/fs/cgroup/cpu,cpuacct") ? "/sys/fs/cgroup/cpu,cpuacct"
+                                                                                : "/sys/fs/cgroup/cpu", cpupath)
+                                : hierarchy("/sys/fs/cgroup", unified);
+    for (unsigned long j = 0; j < dirs.size(); ++j) {
+        double q = 0, period = 0;
+        if (v1cpu) {
+            q = atof(first(dirs[j] + "/cpu.cfs_quota_us").c_str());
+            period = atof(first(dirs[j] + "/cpu.cfs_period_us").c_str());
+        } else {
+            string max;
+            istringstream in(first(dirs[j] + "/cpu.max"));
+            if (in >> max >> period && max != "max") q = atof(max.c_str());
+        }
+        if (q > 0 && period > 0 && (quota == 0 || q / period < quota)) quota = q / period;
+    }
+    dirs = v1mem ? hierarchy("/sys/fs/cgroup/memory", mempath) : hierarchy("/sys/fs/cgroup", unified);
+    for (unsigned long j = 0; j < dirs.size(); ++j) {
+        string file = dirs[j] + (v1mem ? "/memory.limit_in_bytes" : "/memory.max");
+        string text = first(file);
+        unsigned long l = strtoul(text.c_str(), NULL, 10);
+        if (text.empty() || text == "max" || l == 0 || l >= UNLIMITED) continue;
+        if (limit == 0 || l < limit) {
+            limit = l;
+            usage = dirs[j] + (v1mem ? "/memory.usage_in_bytes" : "/memory.current");
+            stat = dirs[j] + "/memory.stat";
+            cachekey = v1mem ? "total_inactive_file" : "inactive_file";
+        }
+    }
+}
+
+unsigned Resources::workers (unsigned most) const {
+    unsigned n = allowed.size();
+    if (quota > 0) n = std::min(n, static_cast<unsigned>(std::ceil(quota)));
+    return std::max(1U, std::min(n, most));
+}
+
+unsigned long Resources::headroom () const {
+    if (limit > 0) {
+        unsigned long used = strtoul(first(usage).c_str(), NULL, 10);
+        // the page cache is given back before the cgroup runs out
+        unsigned long cache = statvalue(stat, cachekey);
+        used = (cache < used) ? used - cache : 0;
+        return (used < limit) ? limit - used : 0;
+    }
+    ifstream in("/proc/meminfo");
+    string key;
+    unsigned long v;
+    string unit;
+    while (in >> key >> v >> unit) {
+        if (key == "MemAvailable:") return v << 10;
+    }
+    return 0;
+}
+
+vector<int> Resources::place (unsigned wid, string const & pin) const {
+    vector<int> cpus;
+    if (pin == "none" || allowed.empty()) return cpus;
+    int core = allowed[wid % allowed.size()];
+    if (pin == "cores") {
+        cpus.push_back(core);
+        return cpus;
+    }
+    for (unsigned long n = 0; n < numa.size(); ++n) {
+        if (std::find(numa[n].begin(), numa[n].end(), core) != numa[n].end()) return numa[n];
+    }
+    return cpus;
+}
+
+string Resources::describe () const {
+    ostringstream text;
+    if (quota > 0) text << "CPU quota: " << quota << " processors";
+    if (limit > 0) text << (quota > 0 ? ", " : "") << "memory limit: " << (limit >> 20) << " MB";
+    if (numa.size() > 1) text << ((quota > 0 || limit > 0) ? ", " : "") << "NUMA nodes: " << numa.size();
+    return text.str();
+}
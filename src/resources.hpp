@@ -0,0 +1,80 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+
+// the processors and the memory this process may use: its CPU affinity, the
+// CPU quota and the memory limit of its cgroup (v2, or else v1), and the
+// NUMA nodes of the processors
+class Resources {
+private:
+    std::vector<int> allowed;                   // the processors of the affinity mask
+    std::vector<std::vector<int> > numa;        // those of each NUMA node that has any
+    double quota;                               // processors worth of CPU time, 0 for no quota
+    unsigned long limit;                        // bytes the cgroup may use, 0 for no limit
+    std::string usage;                          // the file of what it uses, with the limit
+    std::string stat;                           // and the file of how much of that is page cache,
+    std::string cachekey;                       // under this key
+
+public:
+    // detected once, when the run starts
+    Resources ();
+
+    std::vector<int> const & cpus () const {
+        return allowed;
+    }
+    std::vector<std::vector<int> > const & nodes () const {
+        return numa;
+    }
+    double cpuquota () const {
+        return quota;
+    }
+    unsigned long memory () const {
+        return limit;
+    }
+
+    // the workers that keep every processor the process may use busy,
+    // at most the given number
+    unsigned workers (unsigned most) const;
+
+    // the bytes of memory still free for more solves: below the cgroup
+    // limit, apart from page cache, or else available on the machine
+    unsigned long headroom () const;
+
+    // the processors the solves of a worker run on: none for no pinning,
+    // one core for each worker in turn with cores, or the node of that
+    // core with nodes; empty for not pinned
+    std::vector<int> place (unsigned wid, std::string const & pin) const;
+
+    // a line on the limits found, empty when there are none
+    std::string describe () const;
+};
@@ -0,0 +1,128 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// one random number layer for all the samplers
+// the distributions are computed here rather than with <random>, whose
+// algorithms differ between standard libraries, so that a given seed
+// gives the same samples on every platform
+#include <cmath>
+#include "rng.hpp"
+
+using std::vector;
+
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+Rng::Rng (unsigned long seed, unsigned long stream) : used(4) {
+    uint64_t s = seed;
+    uint64_t t = stream;
+    key[0] = uint32_t(s);
+    key[1] = uint32_t(s >> 32);
+    counter[0] = 0;
+    counter[1] = 0;
+    counter[2] = uint32_t(t);
+    counter[3] = uint32_t(t >> 32);
+}
+
+void philox (uint32_t const counter[4], uint32_t const key[2], uint32_t block[4]) {
+    uint32_t x[4] = { counter[0], counter[1], counter[2], counter[3] };
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = uint64_t(PHILOX_M0) * x[0];
+        uint64_t p1 = uint64_t(PHILOX_M1) * x[2];
+        uint32_t y0 = uint32_t(p1 >> 32) ^ x[1] ^ k0;
+        uint32_t y1 = uint32_t(p1);
+        uint32_t y2 = uint32_t(p0 >> 32) ^ x[3] ^ k1;
+        uint32_t y3 = uint32_t(p0);
+        x[0] = y0; x[1] = y1; x[2] = y2; x[3] = y3;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    block[0] = x[0]; block[1] = x[1]; block[2] = x[2]; block[3] = x[3];
+}
+
+void Rng::refill () {
+    philox(counter, key, block);
+    used = 0;
+
+    // advance the 64 bit position
+    if (++counter[0] == 0) ++counter[1];
+}
+
+uint32_t Rng::next32 () {
+    if (used == 4) refill();
+    return block[used++];
+}
+
+uint64_t Rng::next64 () {
+    uint64_t hi = next32();
+    return (hi << 32) | next32();
+}
+
+double Rng::uniform () {
+    return double(next64() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double Rng::uniform (double a, double b) {
+    return a + (b - a) * uniform();
+}
+
+// Box-Muller; the second variate is dropped so that every
+// draw uses the same number of words of the stream
+double Rng::normal (double mu, double sigma) {
+    double u1 = 1.0 - uniform();        // in (0, 1]
+    double u2 = uniform();
+    return mu + sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+double Rng::exponential (double lambda) {
+    return -log(1.0 - uniform()) / lambda;
+}
+
+bool Rng::bernoulli (double p) {
+    return uniform() < p;
+}
+
+int Rng::discrete (vector<double> const & weights) {
+    double total = 0.0;
+    for (unsigned long i = 0; i < weights.size(); ++i) total += weights[i];
+    double u = uniform() * total;
+    for (unsigned long i = 0; i + 1 < weights.size(); ++i) {
+        if (u < weights[i]) return i;
+        u -= weights[i];
+    }
+    return weights.size() - 1;
+}
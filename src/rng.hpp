@@ -0,0 +1,69 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Philox4x32-10 counter-based generator
+// (Salmon, Moraes, Dror and Shaw. SC 2011.)
+
+// one block of it: the ten rounds over the counter with the key
+void philox (uint32_t const counter[4], uint32_t const key[2], uint32_t block[4]);
+
+// an Rng is a stream identified by (master seed, stream id): draws of
+// stream i do not depend on how many draws other streams made, so a
+// stream per sample index gives the same samples whatever the threads
+class Rng {
+private:
+    uint32_t key[2];
+    uint32_t counter[4];                // counter[0..1] the position, counter[2..3] the stream
+    uint32_t block[4];                  // the current output block
+    int used;                           // words of block already returned
+
+    void refill ();
+
+public:
+    Rng (unsigned long seed, unsigned long stream);
+
+    uint32_t next32 ();
+    uint64_t next64 ();
+
+    // in [0, 1), with 53 random bits
+    double uniform ();
+
+    double uniform (double a, double b);
+    double normal (double mu, double sigma);
+    double exponential (double lambda);
+    bool bernoulli (double p);
+
+    // an index drawn with probability proportional to its weight
+    int discrete (std::vector<double> const & weights);
+};
@@ -0,0 +1,481 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// compile the random variable declarations of a pdrh model once, and
+// sample all of them without any string parsing or regular expressions
+// Bernoulli, Uniform, Normal, Exponential, and discrete (DD) distributions,
+// with or without a leading "j" for the random variables of probabilistic jumps
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <gsl/gsl_cdf.h>
+#include "rvprog.hpp"
+#include "evalrv.hpp"
+#include "util.hpp"
+
+using std::cout;
+using std::endl;
+using std::map;
+using std::string;
+using std::vector;
+using std::ostringstream;
+
+// split s at the separator, ignoring separators inside parentheses
+static vector<string> split_top (string const & s, char sep) {
+    vector<string> parts;
+    int depth = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '(') depth++;
+        else if (s[i] == ')') depth--;
+        else if (s[i] == sep && depth == 0) {
+            parts.push_back(s.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    parts.push_back(s.substr(start));
+    return parts;
+}
+
+// compile a parameter, over the jump random variables it may refer to
+static RVParam compile_param (string const & text, map<string, int> const & jumps, string const & line) {
+    RVParam p;
+    p.value = 0.0;
+    try {
+        p.expr = Expr(text, jumps);
+        p.refs = p.expr.uses();
+        if (p.constant()) p.value = p.expr.value(vector<double>());
+    } catch (char const * why) {
+        fail(string("cannot evaluate the parameter ") + trim(text) + " (" + why + ")", line);
+    }
+    return p;
+}
+
+RVProgram::RVProgram (vector<string> const & distrfile) {
+
+    // parse the declarations: <kind>(<parameters>) <name>;
+    vector<RandomVar> decls;
+    vector< vector<string> > params;
+    vector<string> lines;
+    map<string, int> jumps;
+    int numjumps = 0;
+
+    for (unsigned long i = 0; i < distrfile.size(); ++i) {
+        string const & line = distrfile[i];
+        RandomVar v;
+
+        size_t open = line.find('(');
+        if (open == string::npos) fail("cannot parse the random variable declaration", line);
+        string kind = trim(line.substr(0, open));
+        v.jump = (kind.size() > 1 && kind[0] == 'j');
+        if (v.jump) kind = kind.substr(1);
+        if      (kind == "B")  v.kind = RandomVar::BERNOULLI;
+        else if (kind == "U")  v.kind = RandomVar::UNIFORM;
+        else if (kind == "N")  v.kind = RandomVar::NORMAL;
+        else if (kind == "E")  v.kind = RandomVar::EXPONENTIAL;
+        else if (kind == "DD") v.kind = RandomVar::DISCRETE;
+        else fail("unknown distribution " + kind, line);
+
+        // find the matching closing parenthesis
+        size_t close = open;
+        int depth = 0;
+        for (; close < line.size(); ++close) {
+            if (line[close] == '(') depth++;
+            else if (line[close] == ')' && --depth == 0) break;
+        }
+        if (close == line.size()) fail("unbalanced parentheses in the random variable declaration", line);
+
+        string rest = trim(line.substr(close + 1));
+        size_t semi = rest.find(';');
+        if (semi == string::npos) fail("missing ';' in the random variable declaration", line);
+        v.name = trim(rest.substr(0, semi));
+        if (v.name.empty() || !(isalpha(v.name[0]) || v.name[0] == '_')) fail("bad random variable name", line);
+        for (unsigned long c = 0; c < v.name.size(); ++c) {
+            if (!(isalnum(v.name[c]) || v.name[c] == '_')) fail("bad random variable name", line);
+        }
+
+        vector<string> args = split_top(line.substr(open + 1, close - open - 1), ',');
+        if (v.kind == RandomVar::DISCRETE) {
+            vector<string> pairs;
+            for (unsigned long a = 0; a < args.size(); ++a) {
+                vector<string> vp = split_top(args[a], ':');
+                if (vp.size() != 2) fail("DD expects <value>:<probability> pairs", line);
+                pairs.push_back(vp[0]);
+                pairs.push_back(vp[1]);
+            }
+            args = pairs;
+        } else {
+            unsigned long arity = (v.kind == RandomVar::UNIFORM || v.kind == RandomVar::NORMAL) ? 2 : 1;
+            if (args.size() != arity) fail("wrong number of parameters", line);
+        }
+
+        if (v.jump) jumps[v.name] = numjumps++;
+        decls.push_back(v);
+        params.push_back(args);
+        lines.push_back(line);
+    }
+
+    // jump random variables are sampled first, as they can
+    // appear in the parameters of the other ones
+    for (int pass = 0; pass < 2; ++pass) {
+        for (unsigned long i = 0; i < decls.size(); ++i) {
+            if (decls[i].jump != (pass == 0)) continue;
+            RandomVar v = decls[i];
+            map<string, int> none;
+            for (unsigned long a = 0; a < params[i].size(); ++a) {
+                // parameters of jump random variables are constants
+                RVParam p = compile_param(params[i][a], v.jump ? none : jumps, lines[i]);
+                for (unsigned long r = 0; r < p.refs.size(); ++r) {
+                    if (std::find(v.deps.begin(), v.deps.end(), p.refs[r]) == v.deps.end()) v.deps.push_back(p.refs[r]);
+                }
+                v.params.push_back(p);
+            }
+            if (!v.jump) slots.push_back(vars.size());
+            vars.push_back(v);
+        }
+    }
+
+    // the discrete distributions with constant parameters are drawn from tables
+    aliases.resize(vars.size());
+    for (unsigned long i = 0; i < vars.size(); ++i) {
+        if (vars[i].kind != RandomVar::DISCRETE || !vars[i].deps.empty()) continue;
+        vector<double> probs;
+        for (unsigned long k = 1; k < vars[i].params.size(); k += 2) probs.push_back(vars[i].params[k].value);
+        aliases[i] = Alias(probs);
+    }
+}
+
+Alias::Alias (vector<double> const & probs) : cut(probs.size(), 1.0), other(probs.size(), 0) {
+
+    double total = 0.0;
+    for (unsigned long k = 0; k < probs.size(); ++k) total += probs[k];
+    if (!(total > 0)) fail("the probabilities of a discrete distribution must not all be 0", "DD");
+
+    // columns under the mean are filled up by the ones over it
+    unsigned long n = probs.size();
+    vector<double> scaled(n);
+    vector<int> small, large;
+    for (unsigned long k = 0; k < n; ++k) {
+        scaled[k] = probs[k] * n / total;
+        other[k] = k;
+        if (scaled[k] < 1.0) small.push_back(k);
+        else large.push_back(k);
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back(), l = large.back();
+        small.pop_back();
+        cut[s] = scaled[s];
+        other[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // the rest is full up to rounding
+    for (unsigned long k = 0; k < small.size(); ++k) cut[small[k]] = 1.0;
+    for (unsigned long k = 0; k < large.size(); ++k) cut[large[k]] = 1.0;
+}
+
+// the current value of a parameter, given the values sampled so far
+double RVProgram::param (RVParam const & p, vector<double> const & values) const {
+    if (p.constant()) return p.value;
+    try {
+        return p.expr.value(values);
+    } catch (char const * why) {
+        fail("cannot evaluate the parameter", why);
+    }
+    return 0.0;
+}
+
+int RVProgram::find (string const & name) const {
+    for (unsigned long v = 0; v < vars.size(); ++v) {
+        if (vars[v].name == name) return v;
+    }
+    return -1;
+}
+
+void RVProgram::sample (vector<double> & assignment, Rng & rng) const {
+    draw(assignment, rng, NULL, NULL, NULL);
+}
+
+void RVProgram::sample (vector<double> & assignment, Rng & rng, vector<double> const & quantiles) const {
+    draw(assignment, rng, &quantiles, NULL, NULL);
+}
+
+double RVProgram::sample (vector<double> & assignment, Rng & rng, vector<Proposal const *> const & proposals) const {
+    return draw(assignment, rng, NULL, &proposals, NULL);
+}
+
+void RVProgram::sample (vector<double> & assignment, Rng & rng, Atom const & atom) const {
+    draw(assignment, rng, NULL, NULL, &atom);
+}
+
+bool RVProgram::enumerate (vector<Atom> & atoms, unsigned long limit) const {
+
+    // the random variables to enumerate, in order, so that the ones
+    // their parameters depend on have their values when they are reached
+    vector<int> discrete;
+    vector<bool> enumerated(vars.size(), false);
+    for (unsigned long i = 0; i < vars.size(); ++i) {
+        RandomVar const & v = vars[i];
+        if (v.kind != RandomVar::BERNOULLI && v.kind != RandomVar::DISCRETE) continue;
+        bool ok = true;
+        for (unsigned long d = 0; d < v.deps.size(); ++d) ok = ok && enumerated[v.deps[d]];
+        if (ok) {
+            enumerated[i] = true;
+            discrete.push_back(i);
+        }
+    }
+
+    // depth first over the outcomes of each variable in turn; the
+    // assignments reached more than once (a DD value listed twice)
+    // are merged
+    map<vector<double>, double> found;
+    vector<double> values(vars.size(), NAN);
+    vector<double> outcomes, probs;
+    vector<double> prob(discrete.size() + 1, 1.0);
+    vector<unsigned long> next(discrete.size() + 1, 0);
+    unsigned long depth = 0;
+
+    while (true) {
+        if (depth == discrete.size()) {
+            found[values] += prob[depth];
+            if (found.size() > limit) return false;
+            if (depth == 0) break;
+            depth--;
+            continue;
+        }
+        RandomVar const & v = vars[discrete[depth]];
+        outcomes.clear();
+        probs.clear();
+        if (v.kind == RandomVar::BERNOULLI) {
+            double p = param(v.params[0], values);
+            if (p < 0 || p > 1) fail("a Bernoulli probability must be in [0, 1]", v.name);
+            outcomes.push_back(1);
+            probs.push_back(p);
+            outcomes.push_back(0);
+            probs.push_back(1 - p);
+        } else {
+            // the weights of a DD are normalized, as when sampling
+            double sum = 0;
+            for (unsigned long k = 0; k + 1 < v.params.size(); k += 2) {
+                outcomes.push_back(param(v.params[k], values));
+                probs.push_back(param(v.params[k + 1], values));
+                sum += probs.back();
+            }
+            if (sum <= 0) fail("the probabilities of a DD must not sum to 0", v.name);
+            for (unsigned long k = 0; k < probs.size(); ++k) probs[k] /= sum;
+        }
+        // skip the outcomes that cannot happen
+        while (next[depth] < outcomes.size() && probs[next[depth]] <= 0) next[depth]++;
+        if (next[depth] == outcomes.size()) {
+            next[depth] = 0;
+            values[discrete[depth]] = NAN;
+            if (depth == 0) break;
+            depth--;
+            continue;
+        }
+        values[discrete[depth]] = outcomes[next[depth]];
+        prob[depth + 1] = prob[depth] * probs[next[depth]];
+        next[depth]++;
+        depth++;
+    }
+
+    atoms.clear();
+    for (map<vector<double>, double>::const_iterator it = found.begin(); it != found.end(); ++it) {
+        Atom a;
+        a.values = it->first;
+        a.prob = it->second;
+        atoms.push_back(a);
+    }
+    return true;
+}
+
+// the density of U(a, b), N(a, b) or E(a) at x
+static double density (RandomVar::Kind kind, double a, double b, double x) {
+    if (kind == RandomVar::UNIFORM) {
+        return (x >= a && x <= b && b > a) ? 1.0 / (b - a) : 0.0;
+    }
+    if (kind == RandomVar::EXPONENTIAL) {
+        return (x >= 0) ? a * exp(-a * x) : 0.0;
+    }
+    double z = (x - a) / b;
+    return exp(-0.5 * z * z) / (b * sqrt(2 * M_PI));
+}
+
+// the value of random variable i, given the values of the ones before it
+double RVProgram::value (unsigned long i, vector<double> const & values, Rng & rng, double u,
+                         Proposal const * q, double & ratio) const {
+
+    RandomVar const & v = vars[i];
+    switch (v.kind) {
+        case RandomVar::BERNOULLI:
+            return rng.bernoulli(param(v.params[0], values)) ? 1.0 : 0.0;
+        case RandomVar::UNIFORM:
+        case RandomVar::NORMAL: {
+            double a = param(v.params[0], values), b = param(v.params[1], values);
+            double x;
+            if (q != NULL) {
+                x = (q->kind == RandomVar::UNIFORM) ? rng.uniform(q->a, q->b) : rng.normal(q->a, q->b);
+                ratio *= density(v.kind, a, b, x) / density(q->kind, q->a, q->b, x);
+            } else if (u > 0.0 && u < 1.0) {
+                x = (v.kind == RandomVar::UNIFORM) ? a + (b - a) * u : a + gsl_cdf_gaussian_Pinv(u, b);
+            } else {
+                x = (v.kind == RandomVar::UNIFORM) ? rng.uniform(a, b) : rng.normal(a, b);
+            }
+            return x;
+        }
+        case RandomVar::EXPONENTIAL: {
+            double lambda = param(v.params[0], values);
+            if (q == NULL) return rng.exponential(lambda);
+            double x = rng.exponential(q->a);
+            ratio *= density(v.kind, lambda, 0, x) / density(q->kind, q->a, 0, x);
+            return x;
+        }
+        case RandomVar::DISCRETE:
+            if (!aliases[i].cut.empty()) return v.params[2 * aliases[i].draw(rng.uniform())].value;
+            vector<double> probs;
+            for (unsigned long k = 1; k < v.params.size(); k += 2) probs.push_back(param(v.params[k], values));
+            return param(v.params[2 * rng.discrete(probs)], values);
+    }
+    return 0.0;
+}
+
+double RVProgram::draw (vector<double> & assignment, Rng & rng, vector<double> const * quantiles,
+                        vector<Proposal const *> const * proposals, Atom const * atom) const {
+
+    vector<double> values(vars.size(), 0.0);
+    double ratio = 1.0;
+
+    for (unsigned long i = 0; i < vars.size(); ++i) {
+        if (atom != NULL && !std::isnan(atom->values[i])) {
+            values[i] = atom->values[i];
+            continue;
+        }
+        double u = (quantiles != NULL) ? (*quantiles)[i] : -1.0;
+        Proposal const * q = (proposals != NULL) ? (*proposals)[i] : NULL;
+        values[i] = value(i, values, rng, u, q, ratio);
+    }
+
+    assignment.resize(slots.size());
+    for (unsigned long j = 0; j < slots.size(); ++j) {
+        assignment[j] = values[slots[j]];
+    }
+    return ratio;
+}
+
+// by column, each variable in one pass over the samples: the draws from the
+// streams come first, then the transforms, in loops simple enough to
+// vectorize; a variable whose parameters are not constant is drawn sample by
+// sample. every stream sees the same draws, in the same order, as with draw()
+void RVProgram::sample (unsigned long n, vector<Rng> & rngs, vector<double> & columns, vector<double> & ratios,
+                        vector<Proposal const *> const * proposals) const {
+
+    vector<double> all(vars.size() * n);
+    vector<double> u1(n), u2(n);
+    vector<double> row(vars.size(), 0.0);
+    ratios.assign(n, 1.0);
+
+    for (unsigned long i = 0; i < vars.size(); ++i) {
+        RandomVar const & v = vars[i];
+        Proposal const * q = (proposals != NULL) ? (*proposals)[i] : NULL;
+        double * x = &all[i * n];
+
+        if (!v.deps.empty()) {
+            for (unsigned long j = 0; j < n; ++j) {
+                for (unsigned long k = 0; k < i; ++k) row[k] = all[k * n + j];
+                x[j] = value(i, row, rngs[j], -1.0, q, ratios[j]);
+            }
+            continue;
+        }
+
+        RandomVar::Kind kind = (q != NULL) ? q->kind : v.kind;
+        double a = (q != NULL) ? q->a : v.params[0].value;
+        double b = (q != NULL) ? q->b : (v.params.size() > 1 ? v.params[1].value : 0.0);
+        switch (kind) {
+            case RandomVar::BERNOULLI:
+                for (unsigned long j = 0; j < n; ++j) u1[j] = rngs[j].uniform();
+                for (unsigned long j = 0; j < n; ++j) x[j] = (u1[j] < a) ? 1.0 : 0.0;
+                break;
+            case RandomVar::UNIFORM:
+                for (unsigned long j = 0; j < n; ++j) u1[j] = rngs[j].uniform();
+                for (unsigned long j = 0; j < n; ++j) x[j] = a + (b - a) * u1[j];
+                break;
+            case RandomVar::NORMAL:
+                for (unsigned long j = 0; j < n; ++j) {
+                    u1[j] = 1.0 - rngs[j].uniform();
+                    u2[j] = rngs[j].uniform();
+                }
+                for (unsigned long j = 0; j < n; ++j) x[j] = a + b * sqrt(-2.0 * log(u1[j])) * cos(2.0 * M_PI * u2[j]);
+                break;
+            case RandomVar::EXPONENTIAL:
+                for (unsigned long j = 0; j < n; ++j) u1[j] = rngs[j].uniform();
+                for (unsigned long j = 0; j < n; ++j) x[j] = -log(1.0 - u1[j]) / a;
+                break;
+            case RandomVar::DISCRETE:
+                for (unsigned long j = 0; j < n; ++j) u1[j] = rngs[j].uniform();
+                for (unsigned long j = 0; j < n; ++j) x[j] = v.params[2 * aliases[i].draw(u1[j])].value;
+                break;
+        }
+        if (q != NULL) {
+            double lambda = v.params[0].value;
+            double c = (v.params.size() > 1) ? v.params[1].value : 0.0;
+            for (unsigned long j = 0; j < n; ++j) ratios[j] *= density(v.kind, lambda, c, x[j]) / density(q->kind, a, b, x[j]);
+        }
+    }
+
+    columns.resize(slots.size() * n);
+    for (unsigned long k = 0; k < slots.size(); ++k) {
+        std::copy(all.begin() + slots[k] * n, all.begin() + (slots[k] + 1) * n, columns.begin() + k * n);
+    }
+}
+
+string RVProgram::format (double x) {
+    ostringstream strs;
+    strs << x;
+    return strs.str();
+}
+
+vector<string> RVProgram::assignment (vector<double> const & assignment) const {
+    vector<string> simres;
+    for (unsigned long j = 0; j < slots.size(); ++j) {
+        simres.push_back(vars[slots[j]].name + " " + format(assignment[j]));
+    }
+    return simres;
+}
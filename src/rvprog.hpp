@@ -0,0 +1,165 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "rng.hpp"
+#include "evalrv.hpp"
+
+// a parameter of a distribution: either a constant, or an arithmetic
+// expression over jump random variables, compiled once
+struct RVParam {
+    double value;                       // the value when constant
+    Expr expr;                          // over the slots of all the random variables
+    std::vector<int> refs;              // the referenced jump random variables
+
+    bool constant () const {
+        return refs.empty();
+    }
+};
+
+// one random variable declared in the pdrh model
+struct RandomVar {
+    enum Kind { BERNOULLI, UNIFORM, NORMAL, EXPONENTIAL, DISCRETE };
+
+    Kind kind;
+    bool jump;                          // declared with a leading "j" (jB, jU, jN, jE)
+    std::string name;
+    std::vector<RVParam> params;        // B(p), U(a, b), N(mu, sigma), E(lambda),
+                                        // DD(v1:p1, ..., vn:pn) as v1, p1, ..., vn, pn
+    std::vector<int> deps;              // jump random variables the parameters depend on
+};
+
+// a distribution drawn from instead of the declared one of a uniform,
+// normal or exponential random variable, for importance sampling:
+// U(a, b) or N(a, b), or E(a) for an exponential one
+struct Proposal {
+    RandomVar::Kind kind;
+    double a, b;
+};
+
+// the alias table of a discrete distribution (Walker 1977, Vose 1991):
+// one uniform u in [0, 1) picks the column k = u * n, and the rest of it
+// picks k itself under cut[k], and other[k] above
+struct Alias {
+    std::vector<double> cut;
+    std::vector<int> other;
+
+    Alias () {
+    }
+
+    Alias (std::vector<double> const & probs);
+
+    int draw (double u) const {
+        double x = u * cut.size();
+        unsigned long k = std::min((unsigned long) x, cut.size() - 1);
+        return (x - k < cut[k]) ? k : other[k];
+    }
+};
+
+// one assignment of the random variables that can be enumerated, with its
+// probability; values[v] is NaN for the random variables left to sampling
+struct Atom {
+    std::vector<double> values;
+    double prob;
+};
+
+// the random variable declarations of a pdrh model, compiled once
+// into a table; sampling is then a numeric loop over the table
+class RVProgram {
+private:
+    std::vector<RandomVar> vars;        // jump random variables first, then the others
+    std::vector<int> slots;             // the non-jump random variables, in declaration order
+    std::vector<Alias> aliases;         // of the discrete ones with constant parameters
+
+    double param (RVParam const & p, std::vector<double> const & values) const;
+    double value (unsigned long i, std::vector<double> const & values, Rng & rng, double u,
+                  Proposal const * q, double & ratio) const;
+    double draw (std::vector<double> & assignment, Rng & rng, std::vector<double> const * quantiles,
+                 std::vector<Proposal const *> const * proposals, Atom const * atom) const;
+
+public:
+    RVProgram (std::vector<std::string> const & distrfile);
+
+    // number of random variables substituted into the drh model
+    unsigned long size () const {
+        return slots.size();
+    }
+
+    // name of the ith random variable of the drh model
+    std::string const & name (unsigned long i) const {
+        return vars[slots[i]].name;
+    }
+
+    // all the random variables, the jump ones included
+    unsigned long count () const {
+        return vars.size();
+    }
+
+    RandomVar const & var (unsigned long v) const {
+        return vars[v];
+    }
+
+    // index of the random variable of that name among all of them, -1 if none
+    int find (std::string const & name) const;
+
+    // draw one value for every random variable of the drh model
+    void sample (std::vector<double> & assignment, Rng & rng) const;
+
+    // the same, except for the uniform and normal random variables v with
+    // quantiles[v] in (0, 1), which take that quantile of their distribution
+    void sample (std::vector<double> & assignment, Rng & rng, std::vector<double> const & quantiles) const;
+
+    // the same, except for the uniform, normal and exponential random
+    // variables v with proposals[v] given, which are drawn from it instead;
+    // return the likelihood ratio of the declared distributions to the proposals
+    double sample (std::vector<double> & assignment, Rng & rng, std::vector<Proposal const *> const & proposals) const;
+
+    // the same, except for the random variables whose value the atom gives
+    void sample (std::vector<double> & assignment, Rng & rng, Atom const & atom) const;
+
+    // the same for n samples at once, with the proposals if given: rngs[j]
+    // is the stream of sample j, left as sample() would leave it, and
+    // columns[i * n + j] the ith value of sample j, ratios[j] its likelihood ratio
+    void sample (unsigned long n, std::vector<Rng> & rngs, std::vector<double> & columns,
+                 std::vector<double> & ratios, std::vector<Proposal const *> const * proposals) const;
+
+    // every assignment, with its probability, of the Bernoulli and discrete
+    // random variables whose parameters depend on no other kind (the others
+    // are left to sampling); false if there are more than limit of them
+    bool enumerate (std::vector<Atom> & atoms, unsigned long limit) const;
+
+    // the "name value" form used by replace() and the sample files
+    std::vector<std::string> assignment (std::vector<double> const & assignment) const;
+
+    static std::string format (double x);
+};
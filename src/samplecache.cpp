@@ -0,0 +1,84 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// remember the dReach verdict of every sampled assignment
+// each assignment is the vector of values of the random variables of the drh model
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include "samplecache.hpp"
+
+using std::vector;
+
+SampleCache::Key SampleCache::canonical (vector<double> const & assignment) {
+    Key k;
+    k.reserve(assignment.size());
+    char text[32];
+    for (unsigned long i = 0; i < assignment.size(); ++i) {
+        // the default formatting of a stream, as RVProgram::format()
+        snprintf(text, sizeof(text), "%g", assignment[i]);
+        double v = strtod(text, NULL);
+        // -0 and 0 are the same assignment
+        k.push_back((v == 0.0) ? 0.0 : v);
+    }
+    return k;
+}
+
+size_t SampleCache::KeyHash::operator() (Key const & k) const {
+    // FNV-1a over the bit patterns
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned long i = 0; i < k.size(); ++i) {
+        uint64_t bits;
+        memcpy(&bits, &k[i], sizeof(bits));
+        for (int b = 0; b < 8; ++b) {
+            h ^= (bits >> (8 * b)) & 0xff;
+            h *= 1099511628211ULL;
+        }
+    }
+    return size_t(h);
+}
+
+int SampleCache::lookup (vector<double> const & assignment) const {
+    Key k = canonical(assignment);
+    Shard const & shard = shards[KeyHash()(k) % SHARDS];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    std::unordered_map<Key, int, KeyHash>::const_iterator it = shard.map.find(k);
+    return (it == shard.map.end()) ? UNKNOWN : it->second;
+}
+
+void SampleCache::insert (vector<double> const & assignment, int result) {
+    Key k = canonical(assignment);
+    Shard & shard = shards[KeyHash()(k) % SHARDS];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    if (shard.map.insert(std::make_pair(k, result)).second) entries++;
+}
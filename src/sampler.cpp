@@ -0,0 +1,304 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// the sampling modes of --sampling
+// a stratified or LHS design is laid over consecutive sample indices, and
+// each sample finds its cell from its index alone, so that the designs
+// stay the same whatever the number of threads
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include "sampler.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::cerr;
+using std::endl;
+
+// the permutations of the LHS designs come from streams of a key of their own
+static const unsigned long PERMUTATIONS = 0xa5a5a5a5a5a5a5a5UL;
+
+// designs are kept small enough to index
+static const unsigned long MAXDESIGN = 1UL << 24;
+
+Sampler::Sampler (RVProgram const & rvp, string const & name, unsigned long n, string const & proposal,
+                  unsigned long s)
+    : rvprog(rvp), seed(s), strata(n), design(1), proposals(rvp.count(), NULL), complete(false) {
+
+    if      (name == "mc")          mode = MONTECARLO;
+    else if (name == "stratified")  mode = STRATIFIED;
+    else if (name == "lhs")         mode = LHS;
+    else if (name == "importance")  mode = IMPORTANCE;
+    else if (name == "exact")       mode = EXACT;
+    else if (name == "ce")          mode = CROSSENTROPY;
+    else fail("--sampling must be mc, stratified, lhs, importance, exact or ce", name);
+
+    for (unsigned long v = 0; v < rvprog.count(); ++v) {
+        RandomVar::Kind kind = rvprog.var(v).kind;
+        if (kind == RandomVar::UNIFORM || kind == RandomVar::NORMAL) dims.push_back(v);
+    }
+
+    if (mode == STRATIFIED || mode == LHS) {
+        if (dims.empty()) fail("no uniform or normal random variable to lay a design over", name);
+        if (strata == 0) strata = (mode == STRATIFIED) ? 2 : 100;
+        if (mode == LHS) {
+            design = strata;
+        } else {
+            for (unsigned long d = 0; d < dims.size(); ++d) {
+                if (design > MAXDESIGN / strata) fail("too many cells, lower --strata", std::to_string(strata));
+                design *= strata;
+            }
+        }
+        if (design > MAXDESIGN) fail("too many samples per design, lower --strata", std::to_string(strata));
+    }
+
+    if (mode == EXACT) {
+        if (!rvprog.enumerate(atoms, MAXDESIGN)) fail("too many assignments to enumerate, use another sampling", name);
+        complete = true;
+        bool any = false;
+        for (unsigned long v = 0; v < rvprog.count(); ++v) {
+            if (std::isnan(atoms[0].values[v])) complete = false;
+            else any = true;
+        }
+        if (!any) fail("no Bernoulli or discrete random variable to enumerate", name);
+    }
+
+    if (mode == IMPORTANCE && proposal.empty()) fail("importance sampling needs --proposal", name);
+    if (mode != IMPORTANCE && !proposal.empty()) fail("--proposal is only for --sampling=importance", proposal);
+    propose(proposal);
+}
+
+void Sampler::propose (string const & proposal) {
+
+    // NAME:U(a,b);NAME:N(mu,sigma);NAME:E(lambda);...
+    vector<string> items;
+    std::istringstream list(proposal);
+    string item;
+    while (getline(list, item, ';')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    proposals.assign(rvprog.count(), NULL);
+    proposed.clear();
+    proposed.reserve(items.size());
+    for (unsigned long i = 0; i < items.size(); ++i) {
+        item = items[i];
+        size_t colon = item.find(':');
+        size_t open = item.find('(', colon);
+        size_t comma = item.find(',', open);
+        size_t close = item.find(')', open);
+        if (colon == string::npos || open != colon + 2 || close != item.size() - 1) {
+            fail("a proposal must look like NAME:U(a,b), NAME:N(mu,sigma) or NAME:E(lambda)", item);
+        }
+        int v = rvprog.find(item.substr(0, colon));
+        if (v < 0) fail("no random variable for the proposal", item);
+        if (proposals[v] != NULL) fail("a second proposal for the random variable", item);
+        RandomVar::Kind kind = rvprog.var(v).kind;
+        char dist = item[colon + 1];
+        if (kind == RandomVar::EXPONENTIAL) {
+            if (dist != 'E') fail("the proposal of an exponential random variable must be E(lambda)", item);
+        } else if (kind == RandomVar::UNIFORM || kind == RandomVar::NORMAL) {
+            if (dist == 'E') fail("an exponential proposal is only for an exponential random variable", item);
+        } else {
+            fail("proposals are only for uniform, normal and exponential random variables", item);
+        }
+
+        Proposal p;
+        bool two = (dist != 'E');
+        if (two != (comma != string::npos && comma < close)) fail("a wrong number of parameters for the proposal", item);
+        string a = item.substr(open + 1, (two ? comma : close) - open - 1);
+        string b = two ? item.substr(comma + 1, close - comma - 1) : "0";
+        char * end;
+        p.a = strtod(a.c_str(), &end);
+        if (a.empty() || *end != '\0') fail("a proposal needs constant parameters", item);
+        p.b = strtod(b.c_str(), &end);
+        if (b.empty() || *end != '\0') fail("a proposal needs constant parameters", item);
+        if (dist == 'U') {
+            p.kind = RandomVar::UNIFORM;
+            if (p.b <= p.a) fail("a uniform proposal needs a < b", item);
+        } else if (dist == 'N') {
+            p.kind = RandomVar::NORMAL;
+            if (p.b <= 0) fail("a normal proposal needs sigma > 0", item);
+        } else if (dist == 'E') {
+            p.kind = RandomVar::EXPONENTIAL;
+            if (p.a <= 0) fail("an exponential proposal needs lambda > 0", item);
+        } else {
+            fail("a proposal must be U(a,b), N(mu,sigma) or E(lambda)", item);
+        }
+        proposed.push_back(p);
+        proposals[v] = &proposed.back();
+    }
+}
+
+// 32-bit finalizer of MurmurHash3
+static uint32_t mix (uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+// the position of x in the random permutation of variable d in design block
+// (d past the variables for the order of the cells of a stratified design);
+// a 4-round Feistel network on the smallest even number of bits covering the
+// design, walked until it lands inside it, so no permutation is stored
+unsigned long Sampler::permute (unsigned long block, unsigned long d, unsigned long x) const {
+
+    Rng keys(seed ^ PERMUTATIONS, block * (dims.size() + 1) + d);
+    uint32_t k[4];
+    for (int r = 0; r < 4; ++r) k[r] = keys.next32();
+
+    int half = 0;
+    while ((1UL << (2 * half)) < design) half++;
+    uint32_t mask = (1UL << half) - 1;
+
+    do {
+        uint32_t l = x >> half, r = x & mask;
+        for (int round = 0; round < 4; ++round) {
+            uint32_t t = r;
+            r = l ^ (mix(r ^ k[round]) & mask);
+            l = t;
+        }
+        x = (static_cast<unsigned long>(l) << half) | r;
+    } while (x >= design);
+    return x;
+}
+
+void Designs::add (unsigned long cell, bool s) {
+    n++;
+    if (s) {
+        sat++;
+        if (stratified) {
+            squares += 2.0 * cells[cell] + 1;
+            cells[cell]++;
+        } else {
+            current++;
+        }
+    }
+    if (!whole()) return;
+    if (!stratified) {
+        squares += double (current) * current;
+        current = 0;
+    }
+
+    // over B designs of the given size, the pooled variance within the cells,
+    // (X - sum x_h^2 / B) / (size^2 B (B - 1)) for the X sat samples, x_h
+    // of them in cell h, or that between the designs, with s_b sat samples
+    // in design b, (sum s_b^2 - X^2 / B) / (size^2 B (B - 1))
+    complete = n / size;
+    if (complete < 2) return;
+    double b = complete, x = sat;
+    double sum = stratified ? x - squares / b : squares - x * x / b;
+    var = std::max(sum, 0.0) / (double (size) * size * b * (b - 1));
+}
+
+double Designs::error (unsigned long m) const {
+    if (complete < 2 || m == 0) return -1;
+    unsigned long df = stratified ? size * (complete - 1) : complete - 1;
+    if (df < MINDF) return -1;
+    return sqrt(var * (complete * size) / m);
+}
+
+Designs Sampler::designs () const {
+    return Designs(mode == STRATIFIED, design);
+}
+
+unsigned long Sampler::cell (unsigned long index) const {
+    return (mode == STRATIFIED) ? permute(index / design, dims.size(), index % design) : 0;
+}
+
+double Sampler::sample (unsigned long index, vector<double> & assignment, Rng & rng) const {
+
+    switch (mode) {
+        case IMPORTANCE:
+        case CROSSENTROPY:
+            return rvprog.sample(assignment, rng, proposals);
+        case EXACT: {
+            Atom const & atom = atoms[index % atoms.size()];
+            rvprog.sample(assignment, rng, atom);
+            return atom.prob * atoms.size();
+        }
+        case STRATIFIED:
+        case LHS: {
+            // the cells are visited in a random order, so that every sample,
+            // and any prefix of a design, is drawn from the distributions
+            unsigned long block = index / design, j = index % design;
+            if (mode == STRATIFIED) j = permute(block, dims.size(), j);
+            vector<double> quantiles(rvprog.count(), -1.0);
+            for (unsigned long d = 0; d < dims.size(); ++d) {
+                // a point inside the cell, never on its border
+                double v = (static_cast<double>(rng.next64() >> 11) + 0.5) / 9007199254740992.0;
+                unsigned long cell;
+                if (mode == LHS) {
+                    cell = permute(block, d, j);
+                } else {
+                    cell = j % strata;
+                    j /= strata;
+                }
+                quantiles[dims[d]] = (cell + v) / strata;
+            }
+            rvprog.sample(assignment, rng, quantiles);
+            return 1.0;
+        }
+        default:
+            rvprog.sample(assignment, rng);
+            return 1.0;
+    }
+}
+
+void Sampler::sample (unsigned long first, unsigned long n, Batch & batch) const {
+
+    batch.first = first;
+    batch.size = n;
+    batch.rngs.clear();
+    batch.rngs.reserve(n);
+    for (unsigned long j = 0; j < n; ++j) batch.rngs.push_back(Rng(seed, first + j));
+
+    if (mode == MONTECARLO || mode == IMPORTANCE || mode == CROSSENTROPY) {
+        rvprog.sample(n, batch.rngs, batch.columns, batch.weights, (mode == MONTECARLO) ? NULL : &proposals);
+        return;
+    }
+    vector<double> values;
+    batch.columns.resize(rvprog.size() * n);
+    batch.weights.resize(n);
+    for (unsigned long j = 0; j < n; ++j) {
+        batch.weights[j] = sample(first + j, values, batch.rngs[j]);
+        for (unsigned long i = 0; i < values.size(); ++i) batch.columns[i * n + j] = values[i];
+    }
+}
@@ -0,0 +1,173 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "rng.hpp"
+#include "rvprog.hpp"
+
+// the sums over the samples so far that the estimators of importance
+// sampling need, the sat samples counting with their likelihood ratio
+struct Weights {
+    double w, w2;                       // sum of the ratios of all the samples, and of their squares
+    double wx, wx2;                     // the same over the sat samples
+
+    Weights () : w(0), w2(0), wx(0), wx2(0) {
+    }
+
+    void add (double weight, bool sat) {
+        w += weight;
+        w2 += weight * weight;
+        if (sat) {
+            wx += weight;
+            wx2 += weight * weight;
+        }
+    }
+};
+
+// the sums over the samples so far that the estimators of the stratified
+// and Latin hypercube designs need, taken in sample order: the variance of
+// the sat fraction of the complete designs, from the sat samples in each
+// cell of a stratified design, which every complete design samples once,
+// or from the sat fraction of each complete Latin hypercube
+struct Designs {
+    // degrees of freedom of the variance before it is used
+    static const unsigned long MINDF = 10;
+
+    bool stratified;                    // else Latin hypercube
+    unsigned long size;                 // samples per design
+    unsigned long n, sat;               // the samples so far, and the sat ones
+    std::vector<uint32_t> cells;        // stratified: the sat samples of each cell
+    double squares;                     // the sum of the squares of those, or of the sat samples of each design
+    unsigned long current;              // Latin hypercube: the sat samples of the design under way
+    unsigned long complete;             // the complete designs at the last end of one
+    double var;                         // and the variance of their sat fraction then
+
+    Designs () : stratified(false), size(1), n(0), sat(0), squares(0), current(0), complete(0), var(0) {
+    }
+
+    Designs (bool strat, unsigned long samples)
+        : stratified(strat), size(samples), n(0), sat(0), cells(strat ? samples : 0, 0), squares(0), current(0),
+          complete(0), var(0) {
+    }
+
+    // the next sample, in the given cell of its stratified design
+    void add (unsigned long cell, bool sat);
+
+    // n samples are some complete designs
+    bool whole () const {
+        return n % size == 0;
+    }
+
+    // the standard error of the sat fraction of m samples, from the complete
+    // designs so far; negative until they have MINDF degrees of freedom
+    double error (unsigned long m) const;
+};
+
+// consecutive samples drawn at once, by column
+struct Batch {
+    unsigned long first;                // the index of the first sample
+    unsigned long size;                 // the number of samples
+    std::vector<double> columns;        // columns[i * size + j]: the ith value of sample first + j
+    std::vector<double> weights;        // their likelihood ratios
+    std::vector<Rng> rngs;              // their streams, past the draws, for drawing again
+};
+
+// how the uniform and normal random variables of a sample are drawn:
+// plain Monte Carlo, stratified (one sample per cell of a grid with
+// <strata> cells per variable), Latin hypercube (designs of <strata>
+// samples, one in each of <strata> slices of every variable), or from the
+// proposals of importance sampling, with likelihood-ratio weights
+// the other random variables are always drawn from their distributions
+// exact: the assignments of the Bernoulli and discrete random variables
+// are enumerated, and taken in turn by consecutive samples, each weighted
+// by its probability times their number; the rest is drawn as usual, so
+// that on a purely discrete model one pass over the assignments gives the
+// probability exactly
+// ce: importance sampling from the proposals the cross-entropy method
+// fitted before the run, given by propose()
+class Sampler {
+public:
+    enum Mode { MONTECARLO, STRATIFIED, LHS, IMPORTANCE, EXACT, CROSSENTROPY };
+
+private:
+    RVProgram const & rvprog;
+    unsigned long seed;                 // the master seed of the run
+    Mode mode;
+    unsigned long strata;
+    unsigned long design;               // samples per design of the stratified and LHS modes
+    std::vector<int> dims;              // the random variables the designs are over
+    std::vector<Proposal> proposed;
+    std::vector<Proposal const *> proposals;    // per random variable, NULL for none
+    std::vector<Atom> atoms;            // the enumerated assignments of the exact mode
+    bool complete;                      // they assign every random variable
+
+    unsigned long permute (unsigned long block, unsigned long d, unsigned long x) const;
+
+public:
+    // the mode named by --sampling, with the --strata and --proposal options
+    // (proposals as NAME:U(a,b), NAME:N(mu,sigma) or NAME:E(lambda),
+    // separated by ';'), drawing from the streams of the master seed
+    Sampler (RVProgram const & rvprog, std::string const & name, unsigned long strata, std::string const & proposal,
+             unsigned long seed);
+
+    // draw from these proposals from now on, in the form of --proposal;
+    // not while sampling
+    void propose (std::string const & proposal);
+
+    Mode get () const { return mode; }
+
+    // the samples carry likelihood-ratio weights
+    bool weighted () const { return mode == IMPORTANCE || mode == EXACT || mode == CROSSENTROPY; }
+
+    // the samples are laid out in stratified or Latin hypercube designs
+    bool designed () const { return mode == STRATIFIED || mode == LHS; }
+
+    // the sums for the designs, empty, and the cell of the stratified
+    // design the sample of the given index is in, 0 for the others
+    Designs designs () const;
+    unsigned long cell (unsigned long index) const;
+
+    // the exact mode on a purely discrete model: the number of samples,
+    // one per assignment, after which the weighted sat fraction is the
+    // exact probability; 0 otherwise
+    unsigned long support () const { return complete ? atoms.size() : 0; }
+
+    // draw the sample of the given index, from the random number stream
+    // of that index; return its likelihood ratio, 1 unless weighted
+    double sample (unsigned long index, std::vector<double> & assignment, Rng & rng) const;
+
+    // the samples of the n indices from first on, the same as those drawn
+    // one at a time; by column over the whole batch where no design or
+    // enumeration is laid over them
+    void sample (unsigned long first, unsigned long n, Batch & batch) const;
+};
@@ -0,0 +1,72 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// the column store of the sampled assignments and their outcomes
+#include <string>
+#include <vector>
+#include "samplestore.hpp"
+
+using std::string;
+using std::vector;
+
+SampleStore::SampleStore (RVProgram const & rvprog) : count(0) {
+    for (unsigned long v = 0; v < rvprog.size(); ++v) {
+        names.push_back(rvprog.name(v));
+    }
+}
+
+SampleStore::~SampleStore () {
+    for (unsigned long b = 0; b < blocks.size(); ++b) {
+        delete blocks[b];
+    }
+}
+
+void SampleStore::add (vector<double> const & assignment, bool sat) {
+    unsigned long i = count % BLOCK;
+    if (i == 0) {
+        Block * block = new Block();
+        block->values.resize(names.size() * BLOCK);
+        block->outcomes.resize(BLOCK / 64, 0);
+        blocks.push_back(block);
+    }
+    Block & block = *blocks.back();
+    for (unsigned long v = 0; v < names.size(); ++v) {
+        block.values[v * BLOCK + i] = assignment[v];
+    }
+    if (sat) block.outcomes[i / 64] |= uint64_t(1) << (i % 64);
+    count++;
+}
+
+void SampleStore::get (unsigned long sample, vector<double> & assignment) const {
+    assignment.resize(names.size());
+    for (unsigned long v = 0; v < names.size(); ++v) {
+        assignment[v] = value(sample, v);
+    }
+}
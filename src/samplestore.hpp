@@ -0,0 +1,87 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "rvprog.hpp"
+
+// the samples of a run, in sample order, stored by column: the names of
+// the random variables once, a double column per random variable and one
+// bit per outcome, in blocks of BLOCK samples that are allocated whole and
+// never moved, so a sample costs 8 bytes per random variable and a bit
+class SampleStore {
+public:
+    static const unsigned long BLOCK = 1UL << 14;  // samples per block
+
+    SampleStore (RVProgram const & rvprog);
+    ~SampleStore ();
+
+    unsigned long size () const {
+        return count;
+    }
+
+    // the random variables of the drh model, the columns
+    unsigned long columns () const {
+        return names.size();
+    }
+
+    std::string const & name (unsigned long v) const {
+        return names[v];
+    }
+
+    // append the next sample
+    void add (std::vector<double> const & assignment, bool sat);
+
+    double value (unsigned long sample, unsigned long v) const {
+        return blocks[sample / BLOCK]->values[v * BLOCK + sample % BLOCK];
+    }
+
+    bool sat (unsigned long sample) const {
+        unsigned long i = sample % BLOCK;
+        return (blocks[sample / BLOCK]->outcomes[i / 64] >> (i % 64)) & 1;
+    }
+
+    void get (unsigned long sample, std::vector<double> & assignment) const;
+
+private:
+    struct Block {
+        std::vector<double> values;     // column v at [v * BLOCK, (v + 1) * BLOCK)
+        std::vector<uint64_t> outcomes; // bit i for sample i of the block
+    };
+
+    std::vector<std::string> names;
+    std::vector<Block *> blocks;
+    unsigned long count;
+
+    SampleStore (SampleStore const &);
+    SampleStore & operator= (SampleStore const &);
+};
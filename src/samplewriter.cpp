@@ -0,0 +1,151 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// buffered text or binary output of the samples of a run
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <stdint.h>
+#include "samplewriter.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::cerr;
+using std::endl;
+
+static std::FILE * open (string const & name) {
+    std::FILE * f = std::fopen(name.c_str(), "wb");
+    if (f == NULL) fail("cannot write the sample file", name);
+    return f;
+}
+
+SampleWriter::SampleWriter (string const & name, SampleStore const & s, string const & directory)
+    : store(s), taken(0), written(0), sat(NULL), unsat(NULL) {
+
+    if      (name == "text")   format = TEXT;
+    else if (name == "binary") format = BINARY;
+    else fail("--output must be text or binary", name);
+
+    if (format == TEXT) {
+        sat = open(directory + "/parameter_values_deltasat.txt");
+        unsat = open(directory + "/parameter_values_unsat.txt");
+        satbuf.reserve(BUFFER + 4096);
+        unsatbuf.reserve(BUFFER + 4096);
+        return;
+    }
+
+    // the schema
+    sat = open(directory + "/parameter_values.bin");
+    uint32_t word = 0x01020304;
+    put(sat, "SREACHS1", 8);
+    put(sat, &word, 4);
+    word = store.columns();
+    put(sat, &word, 4);
+    for (unsigned long v = 0; v < store.columns(); ++v) {
+        word = store.name(v).size();
+        put(sat, &word, 4);
+        put(sat, store.name(v).data(), word);
+    }
+}
+
+SampleWriter::~SampleWriter () {
+    flush();
+    if (sat != NULL) std::fclose(sat);
+    if (unsat != NULL) std::fclose(unsat);
+}
+
+void SampleWriter::put (std::FILE * f, void const * data, size_t size) {
+    if (size > 0 && std::fwrite(data, size, 1, f) != 1) {
+        fail("cannot write the samples", strerror(errno));
+    }
+}
+
+void SampleWriter::update () {
+
+    if (format == BINARY) {
+        taken = store.size();
+        while (taken - written >= ROWS) block();
+        return;
+    }
+
+    // the text of each value as a stream prints it by default, without the stream
+    char text[32];
+    for (; taken < store.size(); ++taken) {
+        string & buf = store.sat(taken) ? satbuf : unsatbuf;
+        for (unsigned long v = 0; v < store.columns(); ++v) {
+            buf += store.name(v);
+            buf += ' ';
+            buf.append(text, snprintf(text, sizeof(text), "%g", store.value(taken, v)));
+            buf += ' ';
+        }
+        buf += '\n';
+        if (buf.size() >= BUFFER) {
+            put(store.sat(taken) ? sat : unsat, buf.data(), buf.size());
+            buf.clear();
+        }
+    }
+    written = taken;
+}
+
+// the next block of at most ROWS of the samples taken
+void SampleWriter::block () {
+    uint32_t rows = std::min(taken - written, (unsigned long) ROWS);
+    vector<double> column(rows);
+    vector<unsigned char> outcomes(rows);
+
+    put(sat, &rows, 4);
+    for (unsigned long v = 0; v < store.columns(); ++v) {
+        for (uint32_t r = 0; r < rows; ++r) column[r] = store.value(written + r, v);
+        put(sat, column.data(), rows * sizeof(double));
+    }
+    for (uint32_t r = 0; r < rows; ++r) outcomes[r] = store.sat(written + r) ? 1 : 0;
+    put(sat, outcomes.data(), rows);
+    written += rows;
+}
+
+void SampleWriter::flush () {
+    update();
+    if (format == BINARY) {
+        while (written < taken) block();
+    } else {
+        put(sat, satbuf.data(), satbuf.size());
+        put(unsat, unsatbuf.data(), unsatbuf.size());
+        satbuf.clear();
+        unsatbuf.clear();
+    }
+    std::fflush(sat);
+    if (unsat != NULL) std::fflush(unsat);
+}
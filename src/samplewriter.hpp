@@ -0,0 +1,74 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <cstdio>
+#include "samplestore.hpp"
+
+// writes the samples of a store out as they arrive, buffered:
+// text, the "name value " lines of parameter_values_deltasat.txt and
+// parameter_values_unsat.txt, or binary, every sample in one file
+// parameter_values.bin laid out by column:
+//   "SREACHS1", uint32 0x01020304 (in the byte order of the file),
+//   uint32 number of columns, then per column uint32 length and name,
+//   then blocks of uint32 rows, rows doubles per column in turn and
+//   rows outcome bytes (1 for sat, 0 for unsat)
+class SampleWriter {
+public:
+    enum Format { TEXT, BINARY };
+
+    static const unsigned long BUFFER = 1UL << 20;  // bytes of text held before a write
+    static const unsigned long ROWS = 1UL << 12;    // samples per binary block
+
+    // the format named by --output, the files in the directory
+    SampleWriter (std::string const & name, SampleStore const & store, std::string const & directory = ".");
+    ~SampleWriter ();
+
+    // take the samples added to the store since the last call
+    void update ();
+
+    // write out everything taken so far
+    void flush ();
+
+private:
+    SampleStore const & store;
+    Format format;
+    unsigned long taken, written;       // samples taken from the store, and written out
+    std::FILE * sat;                    // the text files, or the binary file and NULL
+    std::FILE * unsat;
+    std::string satbuf, unsatbuf;
+
+    void put (std::FILE * f, void const * data, size_t size);
+    void block ();
+
+    SampleWriter (SampleWriter const &);
+    SampleWriter & operator= (SampleWriter const &);
+};
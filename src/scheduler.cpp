@@ -0,0 +1,128 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// the work queue and the completion queue connecting the workers
+// of sreach_para with its aggregator
+#include "scheduler.hpp"
+
+bool WorkQueue::next (unsigned long & index) {
+    for (;;) {
+        if (closed.load()) return false;
+        if (hasretries.load()) {
+            std::lock_guard<std::mutex> lock(retrylock);
+            if (!retries.empty()) {
+                index = retries.back();
+                retries.pop_back();
+                hasretries.store(!retries.empty());
+                return true;
+            }
+        }
+        unsigned long i = issued.load();
+        if (i < bound.load()) {
+            if (issued.compare_exchange_weak(i, i + 1)) {
+                index = i;
+                return true;
+            }
+            continue;
+        }
+
+        // every sample the tests can use is out, wait until the run is
+        // over or a lost one comes back
+        std::unique_lock<std::mutex> lock(retrylock);
+        while (!closed.load() && retries.empty()) {
+            idle.wait(lock);
+        }
+    }
+}
+
+void WorkQueue::limit (unsigned long n) {
+    bound.store(n);
+}
+
+void WorkQueue::retry (unsigned long index) {
+    std::lock_guard<std::mutex> lock(retrylock);
+    retries.push_back(index);
+    hasretries.store(true);
+    idle.notify_one();
+}
+
+void WorkQueue::close () {
+    std::lock_guard<std::mutex> lock(retrylock);
+    closed.store(true);
+    idle.notify_all();
+}
+
+CompletionQueue::~CompletionQueue () {
+    Outcome * o = head.load();
+    while (o != NULL) {
+        Outcome * n = o->next;
+        delete o;
+        o = n;
+    }
+}
+
+void CompletionQueue::push (Outcome * o) {
+    o->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(o->next, o, std::memory_order_release, std::memory_order_relaxed));
+
+    // the aggregator can only be asleep if the queue was empty
+    if (o->next == NULL) {
+        std::lock_guard<std::mutex> lock(sleep);
+        wakeup.notify_one();
+    }
+}
+
+Outcome * CompletionQueue::wait () {
+    Outcome * list = head.exchange(NULL, std::memory_order_acquire);
+    if (list == NULL && !interrupted.load()) {
+        std::unique_lock<std::mutex> lock(sleep);
+        while ((list = head.exchange(NULL, std::memory_order_acquire)) == NULL && !interrupted.load()) {
+            wakeup.wait(lock);
+        }
+    }
+
+    // the list is newest first
+    Outcome * oldest = NULL;
+    while (list != NULL) {
+        Outcome * n = list->next;
+        list->next = oldest;
+        oldest = list;
+        list = n;
+    }
+    return oldest;
+}
+
+void CompletionQueue::interrupt () {
+    std::lock_guard<std::mutex> lock(sleep);
+    interrupted.store(true);
+    wakeup.notify_one();
+}
@@ -0,0 +1,112 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <climits>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// a finished sample, as handed from a worker to the aggregator
+struct Outcome {
+    unsigned long index;                // position of the sample in the stream
+    int result;                         // 1 for sat, 0 for unsat
+    unsigned depth;                     // the first unfolding level found sat, the levels if none
+    unsigned long timeouts;             // dReach runs over the limits for it
+    double weight;                      // its likelihood ratio, 1 unless importance sampling
+    bool guessed;                       // the verdict is the straggler policy's
+    std::vector<double> assignment;     // the values of the random variables of the drh model
+    Outcome * next;
+};
+
+// hands out sample indices to the workers until it is closed
+// no index from the limit on is handed out, the workers wait instead
+class WorkQueue {
+private:
+    std::atomic<unsigned long> issued;
+    std::atomic<unsigned long> bound;   // the limit
+    std::atomic<bool> closed;
+    std::atomic<bool> hasretries;       // retries is not empty
+    std::mutex retrylock;
+    std::condition_variable idle;       // the workers waiting at the limit
+    std::vector<unsigned long> retries; // indices given back by lost workers
+
+public:
+    WorkQueue () : issued(0), bound(ULONG_MAX), closed(false), hasretries(false) {
+    }
+
+    // hand out indices from n on, the ones before are done already
+    void start (unsigned long n) {
+        issued = n;
+    }
+
+    // get the index of the next sample, false once the run is over
+    bool next (unsigned long & index);
+
+    // the tests can use no sample from index n on
+    void limit (unsigned long n);
+
+    // hand out an index again, whose worker was lost before finishing it
+    void retry (unsigned long index);
+
+    void close ();
+
+    bool isclosed () const { return closed.load(); }
+
+    // the next index to hand out, and the limit
+    unsigned long front () const { return issued.load(); }
+    unsigned long ceiling () const { return bound.load(); }
+};
+
+// lock-free multi-producer single-consumer queue of finished samples
+class CompletionQueue {
+private:
+    std::atomic<Outcome *> head;        // last pushed outcome
+    std::atomic<bool> interrupted;
+    std::mutex sleep;                   // only used to sleep when empty
+    std::condition_variable wakeup;
+
+public:
+    CompletionQueue () : head(NULL), interrupted(false) {
+    }
+
+    ~CompletionQueue ();
+
+    void push (Outcome * o);
+
+    // take everything pushed so far, oldest first; block while empty,
+    // unless interrupted
+    Outcome * wait ();
+
+    // wake the aggregator up for good, with nothing if need be, as when a worker fails
+    void interrupt ();
+};
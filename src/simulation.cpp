@@ -36,7 +36,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <random>
+#include <cassert>
 #include <boost/regex.hpp>
 #include "simulation.hpp"
 #include <cstdlib>
@@ -44,20 +44,15 @@
 #include <sstream>
 #include "evalrv.hpp"
 
-using std::bernoulli_distribution;
 using std::cout;
-using std::default_random_engine;
 using std::endl;
-using std::exponential_distribution;
 using std::ifstream;
-using std::normal_distribution;
 using std::ofstream;
 using std::string;
-using std::uniform_real_distribution;
 using std::vector;
 using std::ostringstream;
 
-vector<string> simulation (vector<string> & distrfile){
+vector<string> simulation (vector<string> & distrfile, Rng & rng){
 
     vector<string> assignfile;
 
@@ -102,6 +97,11 @@ vector<string> simulation (vector<string> & distrfile){
                 //cout << equvalstr << endl;
                 ++rit3;
             }
+            // nothing left that folds, such as the sign of U(-5, 5) or an
+            // expression over a random variable: the line stays as it is
+            if (targets.empty()) {
+                break;
+            }
             if (targets.size() != replaces.size()) {
                 cout << "something is wrong with boost regex find" << endl;
                 break;
@@ -142,10 +142,7 @@ vector<string> simulation (vector<string> & distrfile){
                   string paraStr = string() + matches[4];
                   double para = atof(paraStr.c_str());
 
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  bernoulli_distribution distribution(para);
-                  double x = double(distribution(generator));
+                  double x = double(rng.bernoulli(para));
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -172,10 +169,7 @@ vector<string> simulation (vector<string> & distrfile){
               if (boost::regex_match(line2.c_str(), matches, re)) {
                   string paraStr = string() + matches[4];
                   double para = atof(paraStr.c_str());
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  exponential_distribution<double> distribution(para);
-                  double x = distribution(generator);
+                  double x = rng.exponential(para);
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -205,10 +199,7 @@ vector<string> simulation (vector<string> & distrfile){
                   double para1 = atof(paraStr1.c_str());
                   string paraStr2 = string() + matches[8];
                   double para2 =atof(paraStr2.c_str());
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  uniform_real_distribution<double> distribution(para1, para2);
-                  double x = distribution(generator);
+                  double x = rng.uniform(para1, para2);
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -237,10 +228,7 @@ vector<string> simulation (vector<string> & distrfile){
                   double para1 = atof(paraStr1.c_str());
                   string paraStr2 = string() + matches[8];
                   double para2 =atof(paraStr2.c_str());
-                  std::random_device rd;
-                  default_random_engine generator(rd());
-                  normal_distribution<double> distribution(para1, para2);
-                  double x = distribution(generator);
+                  double x = rng.normal(para1, para2);
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -297,22 +285,11 @@ vector<string> simulation (vector<string> & distrfile){
                       iss.clear();
                   }
                   
-                  std::random_device rd;
-                  std::default_random_engine generator(rd());
-                  std::size_t j(0);
                   // call to ddpara2.front() / back() would fail otherwise!
                   assert(!ddpara2.empty());
                   
-                  std::discrete_distribution<> distribution(ddpara2.size(),
-                                                            ddpara2.front(),
-                                                            ddpara2.back(),
-                                                            [&ddpara2,&j](double)
-                                                            {
-                                                                auto w = ddpara2[j];
-                                                                ++j;
-                                                                return w;
-                                                            });
-                  float x = distribution(generator) + 1;
+                  std::vector<double> ddweights(ddpara2.begin(), ddpara2.end());
+                  float x = rng.discrete(ddweights) + 1;
                   std::ostringstream strs;
                   strs << x;
                   std::string x_str = strs.str();
@@ -32,4 +32,5 @@
 #pragma once
 #include <string>
 #include <vector>
-std::vector<std::string> simulation (std::vector<std::string> & distrfile);
+#include "rng.hpp"
+std::vector<std::string> simulation (std::vector<std::string> & distrfile, Rng & rng);
@@ -0,0 +1,605 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// run dReach through a long-lived launcher process instead of system()
+// system() forks the (possibly large and multi-threaded) caller and starts a
+// shell for every sample; the launcher is forked once while the caller is
+// still small, and it starts dReach directly for each model it receives
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sched.h>
+#include "solver.hpp"
+#include "util.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using std::string;
+using std::vector;
+using std::ifstream;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// read exactly n bytes, return false on EOF or error
+bool readall (int fd, void * buf, size_t n) {
+    char * p = static_cast<char *>(buf);
+    while (n > 0) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+// write exactly n bytes, return false on error
+bool writeall (int fd, void const * buf, size_t n) {
+    char const * p = static_cast<char const *>(buf);
+    while (n > 0) {
+        ssize_t r = send(fd, p, n, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+Solver::Solver (string const & dreach, string const & k, string const & delta, bool pipe,
+                double seconds, unsigned long megabytes, vector<int> const & cpus)
+    : dReach(dreach), kunfold(k), precision(delta), launcher(-1), channel(-1), piped(pipe),
+      timeout(seconds), memory(megabytes), cancelled(false), requests(0), interrupts(NULL), pinned(cpus), rss(0),
+      last(0) {
+
+    // the launcher reads which run to interrupt from memory shared with it
+    void * shared = mmap(NULL, sizeof(std::atomic<unsigned long>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                         -1, 0);
+    if (shared == MAP_FAILED) fail("cannot share memory with the dReach launcher");
+    interrupts = new (shared) std::atomic<unsigned long>(0);
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        fail("cannot create the channel to the dReach launcher");
+    }
+    // neither end should leak into dReach or into other launchers' children
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    setsockopt(fds[1], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    // pending output would otherwise be printed twice
+    cout.flush();
+    cerr.flush();
+
+    launcher = fork();
+    if (launcher < 0) {
+        fail("cannot fork the dReach launcher");
+    }
+    if (launcher == 0) {
+        close(fds[0]);
+        channel = fds[1];
+#ifdef __linux__
+        if (!pinned.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (unsigned long j = 0; j < pinned.size(); ++j) CPU_SET(pinned[j], &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+#endif
+        serve();
+        _exit(EXIT_SUCCESS);
+    }
+    close(fds[1]);
+    channel = fds[0];
+}
+
+Solver::~Solver () {
+    // an empty request asks the launcher to exit
+    uint32_t len = 0;
+    writeall(channel, &len, sizeof(len));
+    close(channel);
+    int status;
+    while (waitpid(launcher, &status, 0) < 0 && errno == EINTR);
+    munmap(interrupts, sizeof(std::atomic<unsigned long>));
+}
+
+// the directory of the piped models of a launcher, of its own: dReach
+// writes the files it names after its input next to it; in memory where
+// the system has /dev/shm, else in $TMPDIR or /tmp, and removed with
+// everything in it when the launcher is done
+class Scratch {
+public:
+    string dir;
+
+    Scratch () {
+        char const * tmp = getenv("TMPDIR");
+        string base = (access("/dev/shm", W_OK) == 0) ? "/dev/shm" : (tmp != NULL && *tmp != '\0') ? tmp : "/tmp";
+        string name = base + "/sreachXXXXXX";
+        if (mkdtemp(&name[0]) != NULL) dir = name;
+    }
+
+    ~Scratch () {
+        if (dir.empty()) return;
+        clear(NULL);
+        rmdir(dir.c_str());
+    }
+
+    // remove the files dReach left, every one but keep
+    void clear (char const * keep) const {
+        DIR * d = opendir(dir.c_str());
+        if (d == NULL) return;
+        while (struct dirent * e = readdir(d)) {
+            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+            if (keep != NULL && strcmp(e->d_name, keep) == 0) continue;
+            unlink((dir + "/" + e->d_name).c_str());
+        }
+        closedir(d);
+    }
+
+    // whether dReach wrote some file besides the model
+    bool written (char const * model) const {
+        bool any = false;
+        DIR * d = opendir(dir.c_str());
+        if (d == NULL) return false;
+        while (struct dirent * e = readdir(d)) {
+            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0 || strcmp(e->d_name, model) == 0) continue;
+            any = true;
+        }
+        closedir(d);
+        return any;
+    }
+
+    // the model replaces the previous one
+    bool put (char const * model, string const & text) const {
+        int fd = open((dir + "/" + model).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) return false;
+        char const * p = text.data();
+        size_t n = text.size();
+        while (n > 0) {
+            ssize_t w = write(fd, p, n);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break;
+            p += w;
+            n -= w;
+        }
+        return close(fd) == 0 && n == 0;
+    }
+};
+
+// the process group of the dReach run of the launcher, 0 between runs
+static volatile sig_atomic_t running = 0;
+// set once the solver is cancelled, every later run is killed at once
+static volatile sig_atomic_t stopping = 0;
+// set when the run is killed for taking too long
+static volatile sig_atomic_t timedout = 0;
+// the request whose run is to be killed, as the caller sets it, and the
+// request being served, counted the same way from 1 on
+static std::atomic<unsigned long> * interrupting = NULL;
+static unsigned long serving = 0;
+
+static void onstop (int) {
+    stopping = 1;
+    if (running > 0) kill(-running, SIGKILL);
+}
+
+// a stale interrupt, of a request served already, kills nothing
+static void oninterrupt (int) {
+    if (running > 0 && interrupting->load() == serving) kill(-running, SIGKILL);
+}
+
+static void ontimeout (int) {
+    timedout = 1;
+    if (running > 0) kill(-running, SIGKILL);
+}
+
+// arm the timer of the run, or disarm it with 0
+static void alarmin (double seconds) {
+    struct itimerval t;
+    memset(&t, 0, sizeof(t));
+    t.it_value.tv_sec = static_cast<long>(seconds);
+    t.it_value.tv_usec = static_cast<long>((seconds - t.it_value.tv_sec) * 1e6);
+    if (seconds > 0 && t.it_value.tv_sec == 0 && t.it_value.tv_usec == 0) t.it_value.tv_usec = 1;
+    setitimer(ITIMER_REAL, &t, NULL);
+}
+
+// the launcher dies with the caller, and so should the run in its own group
+static void onquit (int sig) {
+    if (running > 0) kill(-running, SIGKILL);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// start dReach with the given arguments and wait for it, return the wait
+// status, -1 when it could not be run, or TIMEDOUT, and its peak resident
+// set in kB; with an output, the standard output of dReach is read into it
+int Solver::run (vector<char *> & argv, string * output, long & peak) {
+
+    int out[2] = {-1, -1};
+    if (output != NULL) {
+        if (pipe(out) != 0) return -1;
+        fcntl(out[0], F_SETFD, FD_CLOEXEC);
+        fcntl(out[1], F_SETFD, FD_CLOEXEC);
+    }
+
+    // no signal may see the group of a run that is not started or already reaped
+    sigset_t stop, old;
+    sigemptyset(&stop);
+    sigaddset(&stop, SIGUSR1);
+    sigaddset(&stop, SIGUSR2);
+    sigaddset(&stop, SIGALRM);
+    sigaddset(&stop, SIGINT);
+    sigaddset(&stop, SIGTERM);
+    sigprocmask(SIG_BLOCK, &stop, &old);
+
+    int status = -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        sigprocmask(SIG_SETMASK, &old, NULL);
+        if (memory > 0) {
+            // applies to every process of the run on its own
+            struct rlimit r;
+            r.rlim_cur = r.rlim_max = static_cast<rlim_t>(memory) << 20;
+            setrlimit(RLIMIT_AS, &r);
+        }
+        if (output != NULL) dup2(out[1], STDOUT_FILENO);
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+    if (pid > 0) {
+        setpgid(pid, pid);
+        running = pid;
+        timedout = 0;
+        if (stopping || interrupting->load() == serving) kill(-pid, SIGKILL);
+        if (timeout > 0) alarmin(timeout);
+    }
+    sigprocmask(SIG_SETMASK, &old, NULL);
+
+    if (output != NULL) {
+        close(out[1]);
+        output->clear();
+        char buf[4096];
+        for (;;) {
+            ssize_t r = read(out[0], buf, sizeof(buf));
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) break;
+            output->append(buf, r);
+        }
+        close(out[0]);
+    }
+    if (pid > 0) {
+        // wait without reaping, so that the group stays valid until
+        // running is cleared
+        siginfo_t info;
+        while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) < 0 && errno == EINTR);
+        sigprocmask(SIG_BLOCK, &stop, &old);
+        running = 0;
+        if (timeout > 0) alarmin(0);
+        struct rusage usage;
+        memset(&usage, 0, sizeof(usage));
+        while (wait4(pid, &status, 0, &usage) < 0) {
+            if (errno != EINTR) { status = -1; break; }
+        }
+        peak = usage.ru_maxrss;
+        sigprocmask(SIG_SETMASK, &old, NULL);
+
+        // a run that finished just as the timer went off still counts
+        if (timedout && status != -1 && WIFSIGNALED(status)) status = TIMEDOUT;
+    }
+    return status;
+}
+
+// the launcher loop: one request is the name of a .drh file, or the model
+// itself when piped, followed by the precision for it (the default when
+// empty) and the lower and upper unfolding steps (0 and k when the upper
+// one is negative); one reply is the wait status of the dReach run on it, followed
+// by the verdict when piped and its peak resident set
+// piped, the verdict is the one dReach printed, else the one of the
+// .output files it wrote next to the model; the first run with neither
+// is that of a dReach that cannot be piped to, rather than an unsat
+// model without a single path
+void Solver::serve () {
+
+    string optk = kunfold;
+
+    signal(SIGUSR1, onstop);
+    signal(SIGUSR2, oninterrupt);
+    interrupting = interrupts;
+    signal(SIGALRM, ontimeout);
+    signal(SIGINT, onquit);
+    signal(SIGTERM, onquit);
+
+    char const * MODEL = "model.drh";
+    Scratch scratch;
+    string modelfile = scratch.dir + "/" + MODEL;
+    bool first = true;
+
+    for (;;) {
+        uint32_t len;
+        if (!readall(channel, &len, sizeof(len)) || len == 0) return;
+        string request(len, '\0');
+        if (!readall(channel, &request[0], len)) return;
+        uint32_t deltalen;
+        if (!readall(channel, &deltalen, sizeof(deltalen))) return;
+        string delta(deltalen, '\0');
+        if (deltalen > 0 && !readall(channel, &delta[0], deltalen)) return;
+        int32_t depths[2];
+        if (!readall(channel, depths, sizeof(depths))) return;
+        serving++;
+        string optprecision = "-precision=" + (delta.empty() ? precision : delta);
+        string optl = std::to_string(depths[0]);
+        string optu = (depths[1] >= 0) ? std::to_string(depths[1]) : optk;
+
+        vector<char *> argv;
+        argv.push_back(const_cast<char *>(dReach.c_str()));
+        if (depths[0] > 0) {
+            argv.push_back(const_cast<char *>("-l"));
+            argv.push_back(const_cast<char *>(optl.c_str()));
+        }
+        argv.push_back(const_cast<char *>("-u"));
+        argv.push_back(const_cast<char *>(optu.c_str()));
+        argv.push_back(const_cast<char *>(optprecision.c_str()));
+        argv.push_back(const_cast<char *>(piped ? modelfile.c_str() : request.c_str()));
+        argv.push_back(NULL);
+
+        int status = -1;
+        long peak = 0;
+        int result = -1;
+        string output;
+        if (!piped) {
+            status = run(argv, NULL, peak);
+        } else if (scratch.dir.empty() || !scratch.put(MODEL, request)) {
+            status = NOSCRATCH;
+        } else {
+            status = run(argv, &output, peak);
+            if (status >= 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+                result = verdict_output(output);
+                if (result < 0 && (scratch.written(MODEL) || !first)) {
+                    result = verdict(modelfile.substr(0, modelfile.size() - 4), atoi(optu.c_str()));
+                }
+                if (result < 0) result = UNPIPED;
+                first = false;
+            }
+            scratch.clear(MODEL);
+        }
+        if (!writeall(channel, &status, sizeof(status)) || !writeall(channel, &result, sizeof(result))
+            || !writeall(channel, &peak, sizeof(peak))) return;
+    }
+}
+
+void Solver::cancel () {
+    if (!cancelled.exchange(true)) kill(launcher, SIGUSR1);
+}
+
+void Solver::interrupt (unsigned long run) {
+    interrupts->store(run);
+    kill(launcher, SIGUSR2);
+}
+
+// exit with an error unless dReach ran and finished normally
+static void check (int status, string const & calldReach) {
+
+    if (status == -1 || !WIFEXITED(status)) {
+        fail("call to dReach terminated abnormally: " + calldReach);
+    }
+
+    if (WEXITSTATUS(status) == 127) {
+        fail("cannot execute dReach: " + calldReach);
+    }
+
+    if (WEXITSTATUS(status) == EXIT_FAILURE) {
+        fail("call to dReach unsuccessful: " + calldReach);
+    }
+}
+
+// send one request to the launcher and read its reply
+void Solver::request (string const & payload, string const & delta, int lower, int upper,
+                      int & status, int & result, string const & calldReach) {
+
+    uint32_t len = payload.size();
+    uint32_t deltalen = delta.size();
+    int32_t depths[2] = {lower, upper};
+    long peak;
+    requests++;
+    if (len == 0 || !writeall(channel, &len, sizeof(len)) || !writeall(channel, payload.data(), len)
+        || !writeall(channel, &deltalen, sizeof(deltalen)) || !writeall(channel, delta.data(), deltalen)
+        || !writeall(channel, depths, sizeof(depths))
+        || !readall(channel, &status, sizeof(status)) || !readall(channel, &result, sizeof(result))
+        || !readall(channel, &peak, sizeof(peak))) {
+        fail("lost the dReach launcher: " + calldReach);
+    }
+    last.store(peak > 0 ? peak : 0);
+    if (peak > 0 && static_cast<unsigned long>(peak) > rss.load()) rss.store(peak);
+}
+
+// CANCELLED or UNKNOWN when the run was stopped for one of those reasons,
+// -1 when it ran to its end
+int Solver::interrupted (int status) const {
+
+    bool normal = (status >= 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    if ((cancelled.load() || interrupts->load() == requests.load()) && !normal) return CANCELLED;
+    if (status == TIMEDOUT) return UNKNOWN;
+
+    // dReach runs out of memory by dying of a signal
+    if (memory > 0 && status >= 0 && WIFSIGNALED(status)) return UNKNOWN;
+    return -1;
+}
+
+// the command line of a run, for messages
+string Solver::command (string const & file, string const & delta, int lower, int upper) const {
+    string k = (upper >= 0) ? std::to_string(upper) : kunfold;
+    string l = (lower > 0) ? " -l " + std::to_string(lower) : "";
+    return dReach + l + " -u " + k + " -precision=" + (delta.empty() ? precision : delta) + " " + file;
+}
+
+int Solver::solve (string const & drhname, string const & delta, int lower, int upper) {
+
+    string drhfile = drhname + ".drh";
+    string calldReach = command(drhfile, delta, lower, upper);
+
+    int status, result;
+    request(drhfile, delta, lower, upper, status, result, calldReach);
+    int stopped = interrupted(status);
+    if (stopped >= 0) return stopped;
+    check(status, calldReach);
+
+    return verdict(drhname, (upper >= 0) ? upper : atoi(kunfold.c_str()));
+}
+
+int Solver::solve_piped (string const & model, string const & delta, int lower, int upper) {
+
+    string calldReach = command("model.drh", delta, lower, upper);
+
+    int status, result;
+    request(model, delta, lower, upper, status, result, calldReach);
+    if (status == NOSCRATCH) fail("cannot write the piped models to a directory of their own in /dev/shm, $TMPDIR or /tmp");
+    int stopped = interrupted(status);
+    if (stopped >= 0) return stopped;
+    check(status, calldReach);
+
+    if (result == UNPIPED) {
+        fail("dReach printed no verdict and wrote no .output file next to its model, it cannot be used with --io=pipe"
+             " (use --io=file)", calldReach);
+    }
+    // a run that ended with another status is read only when it is 0
+    if (result < 0) fail("dReach exited with status " + std::to_string(WEXITSTATUS(status)) + " and no verdict", calldReach);
+    return result;
+}
+
+
+/* dReach will generate .output files with the names in such a format: ``<model_name>_<k>_i.output'', where k starts from the given lower bound, and i starts from 0. For each k within the given interval, dReach stops when it finds a sat path j, and returns a .output file with the name ``<model_name>_<current_k>_j.output'', in which it says ``delta-sat with delta = ...''. If all the paths are unsat, the final .output one returns “unsat”.
+ */
+
+/* In other words, I just want to know, if given a range for k, there are no sat paths for a given model, what will be the name for the output file concluding that it is unsat. so, only check the file whose name has the largest k and j. if it says “unsat”, it is an unsat case.*/
+
+/* For example, given k \in [0, 3], dreach will first explore paths with no jump. If no sat path with no jump can be found, dreach will then explore paths with 1 jump. That is, dreach never considers paths with a larger step unless all the possible paths with smaller steps are unsat. The whole running of dreach will stop once a sat path has been found. */
+
+int verdict (string const & drhname, int k) {
+
+/* So, if the file ``<modelfilename>_<kupper>_0.output’’ cannot be opened, which means that dreach stops before exploring the whole range for k, we can conclude that dreach has found a sat path. */
+
+/* But, I noticed that there are cases where there is no possible path with k_max jumps. So, by considering this kind of situations, we cannot simply use the above assumption. */
+
+/* So, we first need to find the max k with which at least one possible path that has been explored by dreach. */
+
+    string nusuffix1 = "_" + std::to_string(k) + "_";
+    string outputfilenam = drhname + nusuffix1 + "0.output";
+    ifstream smtresfile (outputfilenam);
+
+    while (!smtresfile.is_open() && k >= 0) {
+        k--;
+        smtresfile.close();
+        smtresfile.clear();
+        nusuffix1.assign("_" + std::to_string(k) + "_");
+        outputfilenam.assign(drhname + nusuffix1 + "0.output");
+        smtresfile.open(outputfilenam);
+    }
+
+/* when dreach considers no paths at all, we will have k = -1 at this time.
+This means that this hybrid system instance is unsat. */
+
+    if (k == -1) return Solver::UNSAT;
+
+/* then,
+   find out the final .output file with the current k returning the answer
+   explore files in a forward manner */
+
+    int dReachi = 0; // the ith possiable path
+    string nusuffix2;
+
+    while (smtresfile.is_open()) {
+        dReachi++;
+        smtresfile.close();
+        smtresfile.clear();
+        nusuffix2.assign(std::to_string(dReachi) + ".output");
+        outputfilenam.assign(drhname + nusuffix1 + nusuffix2);
+        smtresfile.open(outputfilenam);
+    }
+    smtresfile.close();
+    smtresfile.clear();
+
+    dReachi = dReachi - 1;
+    nusuffix2.assign(std::to_string(dReachi) + ".output");
+    outputfilenam.assign(drhname + nusuffix1 + nusuffix2);
+    smtresfile.open(outputfilenam);
+
+    if (!smtresfile.is_open()) {
+        fail("cannot open the dReach returned file");
+    }
+
+    string line;
+    getline(smtresfile, line);
+    smtresfile.close();
+    return (line == "unsat") ? Solver::UNSAT : Solver::SAT;
+}
+
+/* dReach stops at the first sat path and says ``delta-sat with delta = ...'' for it, while an unsat path only says ``unsat''; so, any delta-sat line means sat, and otherwise one unsat line is needed for unsat. */
+
+int verdict_output (string const & output) {
+
+    bool unsat = false;
+    std::istringstream lines(output);
+    string line;
+    while (getline(lines, line)) {
+        unsigned long b = line.find_first_not_of(" \t\r");
+        if (b == string::npos) continue;
+        unsigned long e = line.find_last_not_of(" \t\r");
+        line = line.substr(b, e - b + 1);
+        if (line.compare(0, 9, "delta-sat") == 0) return Solver::SAT;
+        if (line == "unsat") unsat = true;
+    }
+    return unsat ? Solver::UNSAT : -1;
+}
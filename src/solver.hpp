@@ -0,0 +1,133 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <sys/types.h>
+
+// a long-lived launcher process for dReach, one per worker
+// the launcher is forked once, receives model names over a socket
+// and starts dReach directly (no shell) for each of them
+// piped, it receives the model text itself instead, and hands it to dReach
+// in a directory of its own, in memory where the system has one, with the
+// verdict read from the standard output of dReach, or from the .output
+// files it wrote there; no model or .output file reaches the run directory
+// every dReach run gets a process group of its own, so that a cancelled
+// solver can kill it together with whatever it started; the same is done
+// to a run that takes longer than the time limit
+// pinned, the launcher and so every dReach run it starts are kept to the
+// given processors
+class Solver {
+private:
+    std::string dReach;         // the dReach executable
+    std::string kunfold;        // the unfolding steps
+    std::string precision;      // the delta for dReach
+    pid_t launcher;             // pid of the launcher process
+    int channel;                // socket connected to the launcher
+    bool piped;                 // models and verdicts go through streams
+    double timeout;             // seconds per run, 0 for none
+    unsigned long memory;       // megabytes of address space per process, 0 for none
+    std::atomic<bool> cancelled;
+    std::atomic<unsigned long> requests;        // sent to the launcher so far
+    std::atomic<unsigned long> * interrupts;    // shared with it: the request whose run to kill
+    std::vector<int> pinned;    // the processors of the runs, empty for any
+    std::atomic<unsigned long> rss;     // the largest peak resident set of a run so far, in kB
+    std::atomic<unsigned long> last;    // that of the last run
+
+    // the status of a run killed by the time limit, and of a piped
+    // model that could not be written for dReach
+    static const int TIMEDOUT = -2;
+    static const int NOSCRATCH = -3;
+    // the verdict of a piped run that gave none in any way
+    static const int UNPIPED = -2;
+
+    void serve ();
+    int run (std::vector<char *> & argv, std::string * output, long & peak);
+    void request (std::string const & payload, std::string const & delta, int lower, int upper,
+                  int & status, int & result, std::string const & calldReach);
+    std::string command (std::string const & file, std::string const & delta, int lower, int upper) const;
+    int interrupted (int status) const;
+
+public:
+    static const int UNSAT = 0;
+    static const int SAT = 1;
+    static const int CANCELLED = 2;
+    static const int UNKNOWN = 3;       // the run hit the time or the memory limit
+
+    Solver (std::string const & dreach, std::string const & k, std::string const & delta, bool pipe = false,
+            double seconds = 0, unsigned long megabytes = 0, std::vector<int> const & cpus = std::vector<int>());
+    ~Solver ();
+
+    // the largest peak resident set of the dReach runs so far, in kB
+    unsigned long peak () const {
+        return rss.load();
+    }
+
+    // that of the last one
+    unsigned long latest () const {
+        return last.load();
+    }
+
+    // the runs asked for so far, counted from 1 on
+    unsigned long issued () const {
+        return requests.load();
+    }
+
+    // run dReach on <drhname>.drh and return SAT or UNSAT; with the
+    // given precision instead of the default one, if any, and over the
+    // unfolding steps lower to upper instead of 0 to k, if upper >= 0
+    int solve (std::string const & drhname, std::string const & delta = "", int lower = 0, int upper = -1);
+
+    // run dReach on the model text itself, piped solvers only
+    int solve_piped (std::string const & model, std::string const & delta = "", int lower = 0, int upper = -1);
+
+    // kill the running dReach and every later one, when no test needs
+    // their verdicts any more; solve() then returns CANCELLED for them
+    // may be called from any thread, while another one is solving
+    void cancel ();
+
+    // kill the dReach of the given run only, running or yet to start, and
+    // not the later ones, as when a solver shared by several runs is taken
+    // back from one of them; its solve() returns CANCELLED. from any
+    // thread, like cancel()
+    void interrupt (unsigned long run);
+};
+
+// read the verdict of dReach from the <drhname>_<k>_<i>.output files
+int verdict (std::string const & drhname, int k);
+
+// read the verdict of dReach from what it printed, -1 when there is none
+int verdict_output (std::string const & output);
+
+// read or write exactly n bytes on a socket, false on EOF or error
+bool readall (int fd, void * buf, size_t n);
+bool writeall (int fd, void const * buf, size_t n);
@@ -0,0 +1,86 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// the launchers shared by the jobs of sreach_batch, handed out evenly
+#include "solverpool.hpp"
+
+using std::string;
+
+SolverPool::SolverPool (string const & dreach, unsigned long size, bool piped, double timeout, unsigned long memory)
+    : pipe(piped), seconds(timeout), megabytes(memory) {
+    for (unsigned long j = 0; j < size; ++j) {
+        solvers.push_back(std::unique_ptr<Solver>(new Solver(dreach, "", "", piped, timeout, memory)));
+        idle.push_back(solvers.back().get());
+    }
+}
+
+unsigned long SolverPool::holding (unsigned long job) const {
+    std::map<unsigned long, unsigned long>::const_iterator it = held.find(job);
+    return (it == held.end()) ? 0 : it->second;
+}
+
+bool SolverPool::turn (unsigned long job) const {
+    if (idle.empty()) return false;
+    unsigned long mine = holding(job);
+    for (std::map<unsigned long, unsigned long>::const_iterator it = waiting.begin(); it != waiting.end(); ++it) {
+        if (holding(it->first) < mine) return false;
+    }
+    return true;
+}
+
+Solver * SolverPool::acquire (unsigned long job, std::atomic<bool> const & stopped) {
+    std::unique_lock<std::mutex> guard(lock);
+    waiting[job]++;
+    while (!stopped.load() && !turn(job)) freed.wait(guard);
+    if (--waiting[job] == 0) waiting.erase(job);
+    if (stopped.load()) {
+        // the turn may have been this job's
+        freed.notify_all();
+        return NULL;
+    }
+    Solver * solver = idle.back();
+    idle.pop_back();
+    held[job]++;
+    return solver;
+}
+
+void SolverPool::release (unsigned long job, Solver * solver) {
+    std::lock_guard<std::mutex> guard(lock);
+    idle.push_back(solver);
+    if (--held[job] == 0) held.erase(job);
+    freed.notify_all();
+}
+
+void SolverPool::wake () {
+    std::lock_guard<std::mutex> guard(lock);
+    freed.notify_all();
+}
@@ -0,0 +1,91 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "solver.hpp"
+
+// the dReach launchers of sreach_batch, shared by the engines of all its
+// jobs: as many as may run at once, started before any thread; a worker
+// borrows one for each run, with the unfolding steps and the precision of
+// its job given with the run, and the limits and the --io of the pool
+// holding for every job. a free launcher goes to the waiting job holding
+// the fewest, so every job running gets an even share
+class SolverPool {
+private:
+    std::vector<std::unique_ptr<Solver> > solvers;
+    std::vector<Solver *> idle;
+    std::map<unsigned long, unsigned long> held, waiting;      // by job
+    bool pipe;
+    double seconds;
+    unsigned long megabytes;
+    std::mutex lock;
+    std::condition_variable freed;
+
+    // the launchers the job holds
+    unsigned long holding (unsigned long job) const;
+
+    // one is free, and no other job waiting holds fewer
+    bool turn (unsigned long job) const;
+
+public:
+    SolverPool (std::string const & dreach, unsigned long size, bool piped = false, double timeout = 0,
+                unsigned long memory = 0);
+
+    unsigned long size () const {
+        return solvers.size();
+    }
+
+    bool piped () const {
+        return pipe;
+    }
+    double timeout () const {
+        return seconds;
+    }
+    unsigned long memory () const {
+        return megabytes;
+    }
+
+    // a launcher for a run of the job, waiting for its turn; NULL once
+    // stopped is set, as wake() lets it see
+    Solver * acquire (unsigned long job, std::atomic<bool> const & stopped);
+
+    // the launcher back, after the run
+    void release (unsigned long job, Solver * solver);
+
+    // the waiting workers look at their stopped flag again
+    void wake ();
+};
@@ -0,0 +1,321 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <cstdlib>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "options.hpp"
+#include "engine.hpp"
+#include "pdrh.hpp"
+#include "samplecache.hpp"
+#include "solverpool.hpp"
+#include "jobs.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::ifstream;
+using std::ofstream;
+using std::istringstream;
+using std::ostringstream;
+using std::cout;
+using std::endl;
+using std::min;
+
+typedef std::chrono::steady_clock Clock;
+
+static string quoted (string const & s) {
+    string q = "\"";
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '"' || s[i] == '\\') q += '\\';
+        q += s[i];
+    }
+    return q + "\"";
+}
+
+// one line of the manifest
+struct Job {
+    unsigned long line;
+    string testfile, model, k, precision;
+    sreach::Config config;              // with the options of sreach_para given
+    string dir;
+    std::shared_ptr<PdrhModel const> pdrh;
+    SampleCache * cache;                // shared by the jobs of the same model, k and precision
+};
+
+static string basename_of (string const & path) {
+    size_t slash = path.find_last_of('/');
+    string name = (slash == string::npos) ? path : path.substr(slash + 1);
+    if (name.size() > 5 && name.compare(name.size() - 5, 5, ".pdrh") == 0) name.resize(name.size() - 5);
+    return name;
+}
+
+// paths in the manifest are relative to its directory
+static string resolve (string const & path, string const & base) {
+    if (path.empty() || path[0] == '/') return path;
+    return absolute(subdir(base, path));
+}
+
+// the options the pool of launchers takes for every job
+static const char * const SHARED[] = {"io", "timeout", "memory", "pin", "tune", "listen", "remote"};
+
+// the models are read once for all the jobs on them, and the jobs of the
+// same model text, unfolding steps and precision share their verdicts
+static vector<Job> read_manifest (string const & manifest, string const & out,
+                                  map<string, std::shared_ptr<PdrhModel const> > & models,
+                                  map<string, std::unique_ptr<SampleCache> > & caches) {
+    ifstream input(manifest.c_str());
+    if (!input.is_open()) fail("cannot open the manifest", manifest);
+    size_t slash = manifest.find_last_of('/');
+    string base = (slash == string::npos) ? "." : manifest.substr(0, slash);
+
+    vector<Job> jobs;
+    string line;
+    for (unsigned long n = 1; getline(input, line); ++n) {
+        istringstream fields(line);
+        vector<string> words;
+        string w;
+        while (fields >> w) words.push_back(w);
+        if (words.empty() || words[0][0] == '#') continue;
+        string where = "line " + std::to_string(n);
+        if (words.size() < 4) fail("a job needs <testfile> <model> <k> <precision>, " + where, line);
+        Job job;
+        job.line = n;
+        job.testfile = resolve(words[0], base);
+        job.model = resolve(words[1], base);
+        job.k = words[2];
+        job.precision = words[3];
+        job.dir = subdir(out, std::to_string(jobs.size() + 1) + "_" + basename_of(job.model) + "_k" + job.k);
+
+        vector<char *> argv;
+        for (size_t j = 0; j < words.size(); ++j) argv.push_back(&words[j][0]);
+        Options opts(argv.size(), argv.data(), 4);
+        for (size_t j = 0; j < sizeof(SHARED) / sizeof(SHARED[0]); ++j) {
+            if (opts.has(SHARED[j])) fail("--" + string(SHARED[j]) + " is an option of sreach_batch, " + where, line);
+        }
+        job.config.unfoldings = job.k;
+        job.config.precision = job.precision;
+        sreach::take_options(opts, job.config);
+        opts.finish();
+        // the files of a job are found in its directory, as before
+        string * files[] = {&job.config.checkpoint, &job.config.metrics, &job.config.progress};
+        for (size_t j = 0; j < 3; ++j) {
+            if (!files[j]->empty() && (*files[j])[0] != '/') *files[j] = subdir(job.dir, *files[j]);
+        }
+
+        std::shared_ptr<PdrhModel const> & pdrh = models[job.model];
+        if (pdrh == NULL) pdrh = std::make_shared<PdrhModel const>(job.model);
+        job.pdrh = pdrh;
+        ostringstream key;
+        key << job.k << " " << job.precision << "\n" << pdrh->drh();
+        vector<string> rvs = pdrh->distributions();
+        for (size_t j = 0; j < rvs.size(); ++j) key << "\n" << rvs[j];
+        std::unique_ptr<SampleCache> & cache = caches[key.str()];
+        if (cache == NULL) cache.reset(new SampleCache());
+        job.cache = cache.get();
+
+        // the tests are checked at once, and read again by the run
+        vector<Test *> tests = read_tests(job.testfile);
+        for (size_t j = 0; j < tests.size(); ++j) delete tests[j];
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+static int run (int argc, char **argv) {
+
+    const string USAGE =
+    "\nUsage: sreach_batch <manifest> <dReach> [options]\n\n"
+    "where:\n"
+    "      <manifest> lists the jobs, one per line, as\n"
+    "            <testfile> <prob_drh-modelfile> <k> <precision> [options of sreach_para]\n"
+    "          with the paths relative to the manifest; empty lines and lines\n"
+    "          beginning with '#' are ignored;\n"
+    "      <dReach> is the dReach executable, give the path to it.\n\n"
+    "The jobs run in this process, as many at once as --jobs allows, in the\n"
+    "order of the manifest, each in a directory of its own under the output\n"
+    "directory, with its output in sreach.log there.  Their dReach runs share\n"
+    "one pool of launchers, the slots: a free one goes to the running job\n"
+    "holding the fewest, so that every job gets an even share.  The models are\n"
+    "read once, and the jobs of the same model, k and precision share the\n"
+    "verdicts of their samples.  The results of the tests of every job are\n"
+    "collected in jobs.json.\n"
+    "\n"
+    "Options:\n"
+    " --slots=<n>             dReach runs of all the jobs at once (the processors)\n"
+    " --jobs=<n>              jobs running at once (the slots)\n"
+    " --threads=<n>           workers of every job (the slots)\n"
+    " --out=<dir>             the output directory (default batch)\n"
+    " --io=<file|pipe> --timeout=<seconds> --memory=<megabytes> as for\n"
+    "                         sreach_para, for the runs of every job\n"
+    "";
+
+    if (argc < 3) {
+        cout << USAGE << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Options opts(argc, argv, 3);
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long slots = opts.take_ulong("slots", processors > 0 ? processors : 1);
+    unsigned long parallel = opts.take_ulong("jobs", slots);
+    unsigned long perjob = opts.take_ulong("threads", slots);
+    string out = opts.take("out", "batch");
+    string io = opts.take("io", "file");
+    if (io != "file" && io != "pipe") fail("--io must be file or pipe: " + io);
+    double timeout = opts.take_double("timeout", 0);
+    unsigned long memory = opts.take_ulong("memory", 0);
+    opts.finish();
+    if (slots == 0) fail("--slots must be positive", "0");
+    if (parallel == 0) fail("--jobs must be positive", "0");
+    if (perjob == 0) fail("--threads must be positive", "0");
+
+    string dreach = argv[2];
+    if (dreach.find('/') != string::npos) dreach = absolute(dreach);
+    if (mkdir(out.c_str(), 0755) != 0 && errno != EEXIST) fail("cannot create the output directory", out);
+    map<string, std::shared_ptr<PdrhModel const> > models;
+    map<string, std::unique_ptr<SampleCache> > caches;
+    vector<Job> jobs = read_manifest(argv[1], out, models, caches);
+    if (jobs.empty()) {
+        cout << "No job requested - exiting ..." << endl;
+        exit(EXIT_SUCCESS);
+    }
+    string summary = subdir(out, "jobs.json");
+    ofstream json(summary.c_str());
+    if (!json.is_open()) fail("cannot write the results", summary);
+    parallel = min(parallel, (unsigned long) jobs.size());
+    cout << "Jobs: " << jobs.size() << ", slots: " << slots << ", at once: " << parallel << endl;
+
+    // the launchers, started before any thread, with what dReach prints
+    // going to dreach.log in the output directory, as no job has them
+    string dreachlog = subdir(out, "dreach.log");
+    int logfd = open(dreachlog.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (logfd < 0) fail("cannot write the output of dReach", dreachlog);
+    cout.flush();
+    int stdoutfd = dup(STDOUT_FILENO);
+    dup2(logfd, STDOUT_FILENO);
+    close(logfd);
+    std::unique_ptr<SolverPool> launchers;
+    try {
+        launchers.reset(new SolverPool(dreach, slots, io == "pipe", timeout, memory));
+    } catch (...) {
+        dup2(stdoutfd, STDOUT_FILENO);
+        throw;
+    }
+    dup2(stdoutfd, STDOUT_FILENO);
+    close(stdoutfd);
+    SolverPool & pool = *launchers;
+
+    std::atomic<size_t> next(0);
+    std::atomic<unsigned long> failed(0);
+    std::mutex printing;
+    Clock::time_point started = Clock::now();
+
+    // a runner takes the next job, in the order of the manifest, once its last one is over
+    auto runner = [&] () {
+        for (size_t j; (j = next++) < jobs.size(); ) {
+            Job & job = jobs[j];
+            Clock::time_point start = Clock::now();
+            vector<string> found;
+            unsigned long rss = 0;
+            bool ok = true;
+            if (mkdir(job.dir.c_str(), 0755) != 0 && errno != EEXIST) ok = false;
+            ofstream log(subdir(job.dir, "sreach.log").c_str());
+            try {
+                if (!ok || !log.is_open()) fail("cannot write the output of the job", job.dir);
+                sreach::Config config = job.config;
+                config.dreach = dreach;
+                config.threads = perjob;
+                config.piped = pool.piped();
+                config.timeout = pool.timeout();
+                config.memory = pool.memory();
+                config.tune = false;
+                config.directory = job.dir;
+                config.log = &log;
+                sreach::Engine engine(config);
+                engine.load(job.pdrh, job.model);
+                engine.read(job.testfile);
+                engine.share(pool);
+                engine.share(*job.cache);
+                vector<sreach::Result> const & results = engine.run();
+                for (size_t i = 0; i < results.size(); ++i) found.push_back(results[i].text);
+                if (!results.empty()) engine.report(log);
+                rss = engine.peak();
+            } catch (std::exception const & e) {
+                ok = false;
+                if (log.is_open()) log << "Error: " << e.what() << endl;
+            }
+            if (!ok) failed++;
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::lock_guard<std::mutex> guard(printing);
+            cout << "[" << j + 1 << "/" << jobs.size() << "] " << job.dir << ": "
+                 << (ok ? "done" : "failed") << " in " << seconds << " s" << endl;
+            for (size_t i = 0; i < found.size(); ++i) cout << "    " << found[i] << endl;
+
+            json << "{\"job\": " << j + 1 << ", \"line\": " << job.line << ", \"dir\": " << quoted(job.dir)
+                 << ", \"testfile\": " << quoted(job.testfile) << ", \"model\": " << quoted(job.model)
+                 << ", \"k\": " << quoted(job.k) << ", \"precision\": " << quoted(job.precision)
+                 << ", \"outcome\": " << quoted(ok ? "done" : "failed") << ", \"threads\": " << perjob
+                 << ", \"seconds\": " << seconds << ", \"max_rss_kb\": " << rss << ", \"results\": [";
+            for (size_t i = 0; i < found.size(); ++i) json << (i > 0 ? ", " : "") << quoted(found[i]);
+            json << "]}" << endl;
+        }
+    };
+    vector<std::thread> runners;
+    for (unsigned long r = 0; r < parallel; ++r) runners.push_back(std::thread(runner));
+    for (unsigned long r = 0; r < parallel; ++r) runners[r].join();
+
+    cout << "All jobs in " << std::chrono::duration<double>(Clock::now() - started).count() << " s";
+    if (failed > 0) cout << ", " << failed << " failed, see their sreach.log";
+    cout << endl;
+    exit(failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int main (int argc, char **argv) {
+    return guarded(run, argc, argv);
+}
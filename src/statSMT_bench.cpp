@@ -0,0 +1,423 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "options.hpp"
+#include "rng.hpp"
+#include "pdrh.hpp"
+#include "pdrh2drh.hpp"
+#include "presim.hpp"
+#include "prereplace.hpp"
+#include "simulation.hpp"
+#include "replace.hpp"
+#include "evalrv.hpp"
+#include "rvprog.hpp"
+#include "drhtemplate.hpp"
+#include "jobs.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::ifstream;
+using std::ofstream;
+using std::ostream;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since (Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static string quoted (string const & s) {
+    string q = "\"";
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '"' || s[i] == '\\') q += '\\';
+        q += s[i];
+    }
+    return q + "\"";
+}
+
+// the results go to the file and, for the record, to the terminal
+class Results {
+private:
+    ofstream out;
+
+public:
+    Results (string const & file) : out(file.c_str()) {
+        if (!out.is_open()) fail("cannot write the results", file);
+    }
+
+    void add (string const & line) {
+        out << line << endl;
+        cout << line << endl;
+    }
+};
+
+// average time per call of f over iterations calls
+template <class F>
+static void micro (Results & results, string const & model, string const & name, unsigned long iterations, F f) {
+    f();                                // warm up the caches and the files
+    Clock::time_point start = Clock::now();
+    for (unsigned long i = 0; i < iterations; ++i) f();
+    double seconds = since(start);
+
+    std::ostringstream line;
+    line << "{\"benchmark\": " << quoted(name) << ", \"model\": " << quoted(model)
+         << ", \"iterations\": " << iterations << ", \"seconds\": " << seconds
+         << ", \"us_per_call\": " << 1e6 * seconds / iterations << "}";
+    results.add(line.str());
+}
+
+// a building block giving a wrong answer fails the benchmark, before it is timed
+static void check (bool ok, string const & name, string const & why) {
+    if (!ok) fail("wrong result of " + name, why);
+}
+
+static bool same (double x, double y) {
+    return std::fabs(x - y) <= 1e-12 * std::max(1.0, std::fabs(y));
+}
+
+static int run_micro (int argc, char ** argv) {
+    Options opts(argc, argv, 3);
+    unsigned long iterations = opts.take_ulong("iterations", 1000);
+    string out = opts.take("out", "micro.json");
+    opts.finish();
+    if (iterations == 0) fail("iterations must be positive", "0");
+
+    string modelfile = argv[2];
+    PdrhModel pdrh(modelfile);
+    vector<string> distr = pdrh.distributions();
+    if (distr.empty()) fail("no random variables in the model", modelfile);
+    RVProgram rvprog(distr);
+    ModelTemplate model(pdrh, rvprog);
+    // replace() is the path before ModelTemplate, which reads the drh model from a file
+    string drhfile = "model_w_define.drh";
+    pdrh2drh(modelfile, drhfile);
+    Results results(out);
+
+    check(PdrhModel(modelfile).drh() == pdrh.drh(), "pdrh_parse", "the drh model differs between two reads");
+    micro(results, modelfile, "pdrh_parse", iterations, [&]() {
+        PdrhModel parsed(modelfile);
+    });
+
+    // the legacy path draws the jump random variables first, with presim(),
+    // and puts their values into the other declarations, with prereplace()
+    Rng rng(0, 0);
+    auto legacy = [&]() {
+        vector<string> jumps = presim(distr, rng);
+        if (jumps.empty()) return simulation(distr, rng);
+        vector<string> rest = prereplace(distr, jumps);
+        return simulation(rest, rng);
+    };
+    micro(results, modelfile, "simulation", iterations, [&]() {
+        legacy();
+    });
+
+    vector<string> simres = legacy();
+    check(simres.size() == unsigned(rvprog.size()), "simulation",
+          std::to_string(simres.size()) + " values for " + std::to_string(rvprog.size()) + " random variables");
+    micro(results, modelfile, "replace", iterations, [&]() {
+        replace(drhfile, simres, 0);
+    });
+
+    string e = "(1.5 + 2 * 3.25) / (4 - 0.5) - 7 * 1e-3";
+    check(same(eval(e), (1.5 + 2 * 3.25) / (4 - 0.5) - 7 * 1e-3), "eval", e);
+    micro(results, modelfile, "eval", iterations, [&]() {
+        eval(e);
+    });
+
+    map<string, int> names;
+    names["a"] = 0;
+    names["b"] = 1;
+    Expr expr("(a + 2 * b) / (4 - a) - 7 * b ^ 2", names);
+    vector<double> vars(2, 0.5);
+    check(same(expr.value(vars), (0.5 + 2 * 0.5) / (4 - 0.5) - 7 * 0.5 * 0.5), "expr", "(a + 2 * b) / (4 - a) - 7 * b ^ 2");
+    volatile double sink = 0;
+    micro(results, modelfile, "expr", iterations, [&]() {
+        sink = sink + expr.value(vars);
+    });
+
+    vector<double> assignment;
+    micro(results, modelfile, "rvprog", iterations, [&]() {
+        rvprog.sample(assignment, rng);
+    });
+
+    // 256 samples per call, by column
+    vector<Rng> rngs(256, Rng(0, 0));
+    vector<double> columns, ratios;
+    // by column, sample j is the one drawn alone from stream j
+    vector<Rng> streams;
+    for (unsigned long j = 0; j < rngs.size(); ++j) streams.push_back(Rng(0, j));
+    rvprog.sample(streams.size(), streams, columns, ratios, NULL);
+    for (unsigned long j = 0; j < streams.size(); ++j) {
+        Rng alone(0, j);
+        rvprog.sample(assignment, alone);
+        for (unsigned long i = 0; i < assignment.size(); ++i) {
+            check(columns[i * streams.size() + j] == assignment[i], "rvprog_batch_256",
+                  "sample " + std::to_string(j) + " differs from the one drawn alone");
+        }
+    }
+    micro(results, modelfile, "rvprog_batch_256", iterations, [&]() {
+        rvprog.sample(rngs.size(), rngs, columns, ratios, NULL);
+    });
+
+    // the template of the model in memory gives the model of the one read from the drh file
+    string buf, frombuf;
+    model.instantiate(assignment, buf);
+    ModelTemplate(drhfile, rvprog).instantiate(assignment, frombuf);
+    check(buf == frombuf, "instantiate", "the model differs from that of the drh file");
+    micro(results, modelfile, "instantiate", iterations, [&]() {
+        model.instantiate(assignment, buf);
+    });
+
+    unlink("numodel_0.drh");
+    exit(EXIT_SUCCESS);
+}
+
+// the known-answer vectors of Philox4x32-10 in Random123 (kat_vectors):
+// the counter, the key and the block
+static const uint32_t PHILOX_KAT[3][10] = {
+    {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+    {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+     0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+    {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+     0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1},
+};
+
+static string hex (uint32_t const * words, int n) {
+    std::ostringstream text;
+    text << std::hex;
+    for (int i = 0; i < n; ++i) text << (i > 0 ? " " : "") << words[i];
+    return text.str();
+}
+
+// the generator against the known answers, and an Rng against the blocks
+// of its seed as the key and its stream as the high half of the counter
+static int run_kat (int argc, char ** argv) {
+    Options opts(argc, argv, 2);
+    opts.finish();
+
+    for (int v = 0; v < 3; ++v) {
+        uint32_t block[4];
+        philox(PHILOX_KAT[v], PHILOX_KAT[v] + 4, block);
+        check(std::equal(block, block + 4, PHILOX_KAT[v] + 6), "philox",
+              hex(PHILOX_KAT[v], 6) + " gives " + hex(block, 4) + ", not " + hex(PHILOX_KAT[v] + 6, 4));
+    }
+    unsigned long seeds[3][2] = {{0, 0}, {7, 1}, {0x299f31d0a4093822UL, 0x0370734413198a2eUL}};
+    for (int v = 0; v < 3; ++v) {
+        Rng rng(seeds[v][0], seeds[v][1]);
+        uint32_t key[2] = {uint32_t(seeds[v][0]), uint32_t(seeds[v][0] >> 32)};
+        for (uint32_t position = 0; position < 3; ++position) {
+            uint32_t counter[4] = {position, 0, uint32_t(seeds[v][1]), uint32_t(seeds[v][1] >> 32)};
+            uint32_t block[4], drawn[4];
+            philox(counter, key, block);
+            for (int i = 0; i < 4; ++i) drawn[i] = rng.next32();
+            check(std::equal(block, block + 4, drawn), "Rng",
+                  "block " + std::to_string(position) + " of seed " + std::to_string(seeds[v][0]) + ", stream "
+                  + std::to_string(seeds[v][1]) + " is " + hex(drawn, 4) + ", not " + hex(block, 4));
+        }
+    }
+    cout << "Philox4x32-10: the known answers, and the blocks of every Rng, are right" << endl;
+    exit(EXIT_SUCCESS);
+}
+
+// every .pdrh file under dir, in order
+static void find_models (string const & dir, vector<string> & models) {
+    DIR * d = opendir(dir.c_str());
+    if (d == NULL) fail("cannot read the models directory", dir);
+    vector<string> entries;
+    struct dirent * ent;
+    while ((ent = readdir(d)) != NULL) {
+        string name = ent->d_name;
+        if (name != "." && name != "..") entries.push_back(name);
+    }
+    closedir(d);
+    std::sort(entries.begin(), entries.end());
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        string path = dir + "/" + entries[i];
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            find_models(path, models);
+        } else if (path.size() > 5 && path.compare(path.size() - 5, 5, ".pdrh") == 0) {
+            models.push_back(path);
+        }
+    }
+}
+
+// the last line of the --metrics file of a run
+static string last_line (string const & file) {
+    ifstream input(file.c_str());
+    string line, last;
+    while (getline(input, line)) {
+        if (!line.empty()) last = line;
+    }
+    return last;
+}
+
+static double field (string const & json, string const & name) {
+    size_t pos = json.find("\"" + name + "\": ");
+    if (pos == string::npos) return 0;
+    return strtod(json.c_str() + pos + name.size() + 4, NULL);
+}
+
+static int run_corpus (int argc, char ** argv) {
+    if (argc < 6) fail("corpus needs", "<sreach_para> <dReach> <models dir> <testfile>");
+    Options opts(argc, argv, 6);
+    string k = opts.take("k", "3");
+    string precision = opts.take("precision", "0.001");
+    string seed = opts.take("seed", "1");
+    unsigned long threads = opts.take_ulong("threads", 0);
+    unsigned long limit = opts.take_ulong("limit", 600);
+    string out = opts.take("out", "benchmark.json");
+    opts.finish();
+
+    string para = absolute(argv[2]);
+    string dreach = argv[3];
+    if (dreach.find('/') != string::npos) dreach = absolute(dreach);
+    string testfile = absolute(argv[5]);
+    vector<string> models;
+    find_models(argv[4], models);
+    if (models.empty()) fail("no .pdrh models in", argv[4]);
+    Results results(out);
+
+    for (size_t m = 0; m < models.size(); ++m) {
+        // each model runs in a directory of its own, for its output files
+        string dir = "bench_" + std::to_string(m);
+        string model = absolute(models[m]);
+        vector<string> args;
+        args.push_back(para);
+        args.push_back(testfile);
+        args.push_back(model);
+        args.push_back(dreach);
+        args.push_back(k);
+        args.push_back(precision);
+        args.push_back("--seed=" + seed);
+        args.push_back("--metrics=metrics.json");
+
+        Clock::time_point start = Clock::now();
+        pid_t pid = spawn(args, dir, "sreach.log", threads);
+
+        // poll, to kill runs over the limit
+        int status = 0;
+        struct rusage usage;
+        bool killed = false;
+        while (true) {
+            pid_t done = wait4(pid, &status, WNOHANG, &usage);
+            if (done == pid) break;
+            if (done < 0 && errno != EINTR) fail("cannot wait for sreach_para", strerror(errno));
+            if (!killed && since(start) > limit) {
+                kill(pid, SIGKILL);
+                killed = true;
+            }
+            usleep(10000);
+        }
+        double seconds = since(start);
+
+        string metrics = last_line(dir + "/metrics.json");
+        double samples = field(metrics, "samples");
+        double elapsed = field(metrics, "elapsed");
+        string outcome = killed ? "timeout"
+                       : (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? "ok" : "failed";
+
+        std::ostringstream line;
+        line << "{\"benchmark\": \"corpus\", \"model\": " << quoted(models[m])
+             << ", \"outcome\": " << quoted(outcome) << ", \"seconds\": " << seconds
+             << ", \"samples\": " << samples << ", \"solves\": " << field(metrics, "solves")
+             << ", \"timeouts\": " << field(metrics, "timeouts")
+             << ", \"samples_per_second\": " << (elapsed > 0 ? samples / elapsed : 0)
+             << ", \"max_rss_kb\": " << usage.ru_maxrss << "}";
+        results.add(line.str());
+    }
+    exit(EXIT_SUCCESS);
+}
+
+static int run (int argc, char **argv) {
+
+    const string USAGE =
+    "\nUsage: sreach_bench micro <pdrh-file> [--iterations=1000] [--out=micro.json]\n"
+    "       sreach_bench corpus <sreach_para> <dReach> <models dir> <testfile> [options]\n"
+    "       sreach_bench kat\n\n"
+    "micro times the building blocks of a sample (simulation(), replace(), eval(),\n"
+    "the compiled expressions, the random variable program and the model template)\n"
+    "on the model, in microseconds per call, once each has given the right result.\n\n"
+    "kat checks the Philox4x32-10 generator against the known answers of Random123.\n\n"
+    "corpus runs sreach_para on every .pdrh model under the directory, each in a\n"
+    "directory bench_<i> of its own, and records the wall time, the samples, the\n"
+    "dReach runs, the samples per second and the peak resident set of each run.\n\n"
+    "Options of corpus:\n"
+    " --k=<k>                 the unrolling depth (default 3)\n"
+    " --precision=<delta>     the precision of dReach (default 0.001)\n"
+    " --seed=<n>              the master seed of the runs (default 1)\n"
+    " --threads=<n>           OMP_NUM_THREADS of the runs (default unset)\n"
+    " --limit=<seconds>       kill the runs over that time (default 600)\n"
+    " --out=<file>            the results, as JSON lines (default benchmark.json)\n"
+    "";
+
+    if (argc < 2 || (argc < 3 && string(argv[1]) != "kat")) {
+        cout << USAGE << endl;
+        exit(EXIT_FAILURE);
+    }
+    string mode = argv[1];
+    if (mode == "micro") return run_micro(argc, argv);
+    if (mode == "corpus") return run_corpus(argc, argv);
+    if (mode == "kat") return run_kat(argc, argv);
+    cout << USAGE << endl;
+    exit(EXIT_FAILURE);
+}
+
+int main (int argc, char **argv) {
+    return guarded(run, argc, argv);
+}
@@ -0,0 +1,239 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// sreach_replay: runs the tests of a test file many times over simulated
+// outcome streams, to see how many samples they take and how often they
+// are wrong, without calling dReach
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <omp.h>
+#include "options.hpp"
+#include "rng.hpp"
+#include "stattest.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::vector;
+using std::ifstream;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::min;
+
+// the streams the tests of each replication are seeded from, apart from
+// those of the outcomes
+static const unsigned long TESTS = 1UL << 63;
+
+// the samples recorded in one of the parameter_values files of a run
+static unsigned long count_samples (string const & file) {
+    ifstream input(file.c_str());
+    if (!input.is_open()) {
+        cerr << "Error: cannot open sample file: " << file << endl;
+        exit(EXIT_FAILURE);
+    }
+    unsigned long n = 0;
+    string line;
+    while (getline(input, line)) {
+        if (line.find_first_not_of(" \t\r") != string::npos) n++;
+    }
+    return n;
+}
+
+// the outcome of one test in one replication
+struct Run {
+    bool done;
+    unsigned long samples;
+    unsigned int result;
+    bool correct;               // hypothesis tests: right for the true probability
+    double estimate;
+};
+
+static double percentile (vector<unsigned long> const & sorted, double q) {
+    return sorted[min(sorted.size() - 1, (size_t)(q * (sorted.size() - 1) + 0.5))];
+}
+
+static void report (Test const & test, vector<Run> const & runs, double p) {
+
+    vector<unsigned long> samples;
+    unsigned long nulls = 0, wrong = 0, covered = 0;
+    double sum = 0, sum2 = 0, sqerr = 0, estimates = 0;
+
+    HTest const * htest = dynamic_cast<HTest const *>(&test);
+    Estim const * estim = dynamic_cast<Estim const *>(&test);
+
+    for (size_t r = 0; r < runs.size(); r++) {
+        if (!runs[r].done) continue;
+        samples.push_back(runs[r].samples);
+        sum += runs[r].samples;
+        sum2 += double(runs[r].samples) * runs[r].samples;
+        if (htest != NULL) {
+            if (runs[r].result == HTest::NULLHYP) nulls++;
+            if (!runs[r].correct) wrong++;
+        } else {
+            double e = runs[r].estimate - p;
+            estimates += runs[r].estimate;
+            sqerr += e * e;
+            if (fabs(e) <= estim->halfwidth(p)) covered++;
+        }
+    }
+
+    cout << test.getArgs() << ": replications = " << runs.size()
+         << ", undecided = " << runs.size() - samples.size() << endl;
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    double n = samples.size();
+    double mean = sum / n;
+    cout << "    samples: mean = " << mean
+         << ", std. dev. = " << sqrt(std::max(sum2 / n - mean * mean, 0.0))
+         << ", min = " << samples.front()
+         << ", median = " << percentile(samples, 0.5)
+         << ", 90% = " << percentile(samples, 0.9)
+         << ", 99% = " << percentile(samples, 0.99)
+         << ", max = " << samples.back() << endl;
+    if (htest != NULL) {
+        cout << "    Accept Null = " << nulls / n << ", Reject Null = " << 1 - nulls / n
+             << ", error rate = " << wrong / n << endl;
+    } else {
+        cout << "    estimate: mean = " << estimates / n << ", RMSE = " << sqrt(sqerr / n);
+        if (estim->halfwidth(p) > 0) cout << ", within delta = " << covered / n;
+        cout << endl;
+    }
+}
+
+static int run (int argc, char **argv) {
+
+    const string USAGE =
+    "\nUsage: sreach_replay <testfile> <replications> [options]\n\n"
+    "where:\n"
+    "      <testfile> is a test file, as for sreach_sq and sreach_para;\n"
+    "      <replications> is how many times each test is run.\n\n"
+    "Each replication feeds the tests a fresh stream of sat/unsat outcomes, drawn\n"
+    "with probability p of sat, until every test is done.\n"
+    "\n"
+    "Options:\n"
+    " --p=<p>                 the probability of the outcome streams\n"
+    " --sat=<file> --unsat=<file>\n"
+    "                         the parameter_values_deltasat.txt and parameter_values_unsat.txt\n"
+    "                         of a run with --sampling=mc: the streams are resampled from its\n"
+    "                         outcomes, with p the fraction of them that were sat\n"
+    " --max=<n>               give up on a replication after n samples (default 1000000)\n"
+    " --seed=<n>              the master seed of the streams (default 0)\n"
+    "";
+
+    if (argc < 3) {
+        cout << USAGE << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Options opts(argc, argv, 3);
+    unsigned long replications = strtoul(argv[2], NULL, 10);
+    bool recorded = opts.has("sat") || opts.has("unsat");
+    if (recorded == opts.has("p")) {
+        cerr << "Error: give either --p=<p> or --sat=<file> and --unsat=<file>" << endl;
+        exit(EXIT_FAILURE);
+    }
+    double p;
+    if (recorded) {
+        unsigned long sats = count_samples(opts.take("sat"));
+        unsigned long unsats = count_samples(opts.take("unsat"));
+        if (sats + unsats == 0) {
+            cerr << "Error: no samples recorded" << endl;
+            exit(EXIT_FAILURE);
+        }
+        p = double(sats) / (sats + unsats);
+        cout << "Recorded samples: " << sats << " sat, " << unsats << " unsat" << endl;
+    } else {
+        p = opts.take_double("p", 0);
+    }
+    if (p < 0 || p > 1) {
+        cerr << "Error: p must be in [0, 1]: " << p << endl;
+        exit(EXIT_FAILURE);
+    }
+    unsigned long maxsamples = opts.take_ulong("max", 1000000);
+    unsigned long seed = opts.take_ulong("seed", 0);
+    opts.finish();
+
+    vector<string> specs;
+    vector<Test *> tests = read_tests(argv[1], &specs, seed);
+    if (tests.empty()) {
+        cout << "No test requested - exiting ..." << endl;
+        exit (EXIT_SUCCESS);
+    }
+    cout << "p = " << p << ", replications = " << replications << ", random seed: " << seed << endl;
+
+    // runs[j][r]: test j in replication r; replication r draws from stream r,
+    // and seeds its tests from stream TESTS + r
+    vector<vector<Run> > runs(tests.size(), vector<Run>(replications));
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long r = 0; r < (long) replications; r++) {
+        Rng coins(seed, TESTS + r);
+        unsigned long testseed = coins.next64();
+        vector<Test *> mine;
+        for (size_t j = 0; j < specs.size(); j++) mine.push_back(make_test(specs[j], testseed));
+
+        Rng rng(seed, r);
+        unsigned long n = 0, x = 0;
+        while (n < min(needed(mine), maxsamples)) {
+            n++;
+            if (rng.bernoulli(p)) x++;
+            for (size_t j = 0; j < mine.size(); j++) {
+                if (!mine[j]->done()) mine[j]->doTest(n, x);
+            }
+        }
+
+        for (size_t j = 0; j < mine.size(); j++) {
+            Run & run = runs[j][r];
+            run.done = mine[j]->done();
+            run.samples = mine[j]->getSamples();
+            run.result = mine[j]->getResult();
+            HTest * htest = dynamic_cast<HTest *>(mine[j]);
+            run.correct = (htest != NULL) && htest->correct(p);
+            Estim * estim = dynamic_cast<Estim *>(mine[j]);
+            run.estimate = (estim != NULL) ? estim->getEstimate() : 0;
+            delete mine[j];
+        }
+    }
+
+    for (size_t j = 0; j < tests.size(); j++) {
+        report(*tests[j], runs[j], p);
+        delete tests[j];
+    }
+    exit(EXIT_SUCCESS);
+}
+
+int main (int argc, char **argv) {
+    return guarded(run, argc, argv);
+}
@@ -0,0 +1,78 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// sreach_worker: checks the models of a sreach_para coordinator on another node
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "options.hpp"
+#include "remote.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+static int run (int argc, char **argv) {
+
+    const string USAGE =
+    "\nUsage: sreach_worker <host> <port> <dReach> [options]\n\n"
+    "where:\n"
+    "      <host> and <port> are where the sreach_para coordinator listens (its --listen);\n"
+    "      <dReach> is the dReach executable on this node, give the path to it.\n\n"
+    "The unfolding steps and the precision are taken from the coordinator.\n"
+    "\n"
+    "Options:\n"
+    " --io=<file|pipe> how the models reach dReach, as for sreach_para\n"
+    "";
+
+    if (argc < 4) {
+        cout << USAGE << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Options opts(argc, argv, 4);
+    string io = opts.take("io", "file");
+    if (io != "file" && io != "pipe") {
+        cerr << "Error: --io must be file or pipe: " << io << endl;
+        exit(EXIT_FAILURE);
+    }
+    opts.finish();
+
+    serve_coordinator(argv[1], strtoul(argv[2], NULL, 10), argv[3], io == "pipe");
+    exit(EXIT_SUCCESS);
+}
+
+int main (int argc, char **argv) {
+    return guarded(run, argc, argv);
+}
@@ -0,0 +1,1212 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+// the statistical tests and estimators of the test files
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <gsl/gsl_cdf.h>
+#include <gsl/gsl_rng.h>
+#include <typeinfo>
+#include "rng.hpp"
+#include "stattest.hpp"
+
+using std::string;
+using std::endl;
+using std::cout;
+using std::cerr;
+using std::istringstream;
+using std::ostringstream;
+using std::vector;
+using std::ifstream;
+using std::max;
+using std::min;
+
+
+// a number of a JSON object, null when it is not finite
+static void number (std::ostream & os, char const * name, double v) {
+  os << ", \"" << name << "\": ";
+  if (std::isfinite(v)) os << v;
+  else os << "null";
+}
+
+
+// Chernoff-Hoeffding bound
+class CHB : public Estim {
+private:
+  unsigned long int N;		// the bound
+
+public:
+  CHB(string v) : Estim(v){
+    N = 0;
+  }
+
+  unsigned long int get_CH_bound() {
+    if (N == 0) {
+      fail("N has not been set");
+    }
+    return N;
+  }
+
+  void init() {
+    string testName;
+
+    // convert test arguments from string to float
+    istringstream inputString(args);
+    inputString >> testName >> delta >> c;			// by default >> skips whitespaces
+
+    // sanity checks
+    if ((delta >= 0.5) || (delta <= 0.0)) {
+      fail(args + " : must have 0 < delta < 0.5");
+    }
+
+    if (c <= 0.0) {
+      fail(args + " : must have c > 0");
+    }
+
+    // compute the Chernoff-Hoeffding bound
+    N = int (ceil (1/(2*pow(delta, 2)) * log(1/(1-c))));
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << delta << " " << c;
+    args = tmp.str();
+  }
+
+  unsigned long int need () const {
+    return N;
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+
+    // the samples arrive in order and no more than the bound are drawn
+    if (n >= N) {
+      out = DONE;
+      samples = n;
+      successes = x;
+      estimate = double (x)/ double(n);
+    }
+  }
+
+  bool stops (double n, double) const {
+    return n >= N;
+  }
+
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const * s) const {
+    number(os, "estimate", (s != NULL) ? s->wx / n : double (x) / n);
+    number(os, "bound", N);
+  }
+
+  // the Chernoff-Hoeffding bound does not hold for weighted samples
+  void doWeighted (unsigned long int, unsigned long int, Weights const &) {
+    fail(args + " : the Chernoff-Hoeffding bound does not hold for weighted samples,"
+         " NORM estimates their mean to a normal interval instead");
+  }
+};
+
+// class for naive sampling
+class NSAM : public Estim {
+private:
+    unsigned long int N;		// the given sample num
+    
+public:
+    NSAM(string v) : Estim(v){
+        N = 0;
+    }
+    
+    unsigned long int get_NSAM_samplenum() {
+        if (N == 0) {
+            fail("N has not been set");
+        }
+        return N;
+    }
+    
+    void init() {
+        string testName;
+        
+        // convert test arguments from string to float
+        istringstream inputString(args);
+        inputString >> testName >> c;			// by default >> skips whitespaces
+        
+        // read the sample num
+        N = int (c);
+        
+        // writes back the test arguments, with proper formatting
+        ostringstream tmp;
+        tmp << testName << " " << c;
+        args = tmp.str();
+    }
+    
+    // done with the first sample when no sample is asked for
+    unsigned long int need () const {
+        return max(N, 1UL);
+    }
+    
+    void doTest (unsigned long int n, unsigned long int x) {
+        
+        // the samples arrive in order and no more than the bound are drawn
+        if (n >= N) {
+            out = DONE;
+            samples = n;
+            successes = x;
+            estimate = double (x)/ double(n);
+        }
+    }
+    
+    bool stops (double n, double) const {
+        return n >= N;
+    }
+    
+    void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const * s) const {
+        number(os, "estimate", (s != NULL) ? s->wx / n : double (x) / n);
+        number(os, "bound", N);
+    }
+    
+    void doWeighted (unsigned long int n, unsigned long int x, Weights const & s) {
+        
+        if (n >= N) {
+            out = DONE;
+            samples = n;
+            successes = x;
+            estimate = s.wx / n;
+            stderror = weightedError(n, s);
+        }
+    }
+    
+    // with the standard error of the designs, once it can be told
+    void doDesigned (unsigned long int n, unsigned long int x, Designs const & d) {
+        
+        doTest(n, x);
+        if (done() && d.error(n) >= 0) stderror = d.error(n);
+    }
+};
+
+
+// estimation to a relative error, for the tiny probabilities of rare
+// events, where the absolute delta of CHB would take too many samples:
+// done once the normal interval of coverage c is within epsilon times the
+// estimate, after at least MINSAT sat samples, or after N samples at the
+// latest; with weighted samples, such as those of --sampling=ce, the
+// interval is that of the weighted mean
+class RelEstim : public Estim {
+private:
+  double epsilon;		// the relative half-interval width
+  unsigned long int N;		// samples at most
+  double reached;		// the relative half-interval width at the end
+
+  static const unsigned long int MINSAT = 10;
+
+  bool within (double n, double x, double p, double se) const {
+    return n >= N || (x >= MINSAT && gsl_cdf_ugaussian_Pinv((1 + c) / 2) * se <= epsilon * p);
+  }
+
+  void finish (unsigned long int n, unsigned long int x, double p, double se) {
+    double z = gsl_cdf_ugaussian_Pinv((1 + c) / 2);
+    if (within(n, x, p, se)) {
+      out = DONE;
+      samples = n;
+      successes = x;
+      estimate = p;
+      stderror = se;
+      reached = (p > 0) ? z * se / p : INFINITY;
+    }
+  }
+
+public:
+  RelEstim(string v) : Estim(v), epsilon(0.0), N(0), reached(0.0) {
+  }
+
+  void init() {
+    string testName;
+    double n = 0;
+
+    // convert test arguments from string to float
+    istringstream inputString(args);
+    inputString >> testName >> epsilon >> c >> n;
+
+    // sanity checks
+    if ((epsilon <= 0.0) || (epsilon >= 1.0)) {
+      fail(args + " : must have 0 < epsilon < 1");
+    }
+
+    if ((c <= 0.0) || (c >= 1.0)) {
+      fail(args + " : must have 0 < c < 1");
+    }
+
+    if (n < 1) {
+      fail(args + " : must have a bound of at least 1 sample");
+    }
+    N = (unsigned long int) n;
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << epsilon << " " << c << " " << N;
+    args = tmp.str();
+  }
+
+  unsigned long int need () const {
+    return N;
+  }
+
+  double halfwidth (double p) const {
+    return epsilon * p;
+  }
+
+  double getRelative () const {
+    return reached;
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+    double p = double (x) / double (n);
+    finish(n, x, p, sqrt(p * (1 - p) / n));
+  }
+
+  bool stops (double n, double x) const {
+    double p = x / n;
+    return within(n, x, p, sqrt(p * (1 - p) / n));
+  }
+
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const * s) const {
+    double p = (s != NULL) ? s->wx / n : double (x) / n;
+    double se = (s != NULL) ? sqrt(max(s->wx2 / n - p * p, 0.0) / n) : sqrt(p * (1 - p) / n);
+    number(os, "estimate", p);
+    number(os, "relative_error", (p > 0) ? gsl_cdf_ugaussian_Pinv((1 + c) / 2) * se / p : INFINITY);
+    number(os, "epsilon", epsilon);
+  }
+
+  void doWeighted (unsigned long int n, unsigned long int x, Weights const & s) {
+    finish(n, x, s.wx / n, weightedError(n, s));
+  }
+
+  // the interval of the designs, at the end of one; till then the bound
+  void doDesigned (unsigned long int n, unsigned long int x, Designs const & d) {
+    double p = double (x) / double (n);
+    double se = designError(n, x, d);
+    if (se >= 0) finish(n, x, p, se);
+    else if (n >= N) finish(n, x, p, (d.error(n) >= 0) ? d.error(n) : sqrt(p * (1 - p) / n));
+  }
+};
+
+
+// estimation to a normal interval: done once the normal interval of
+// coverage c is within delta of the estimate, after at least MINSAT sat
+// samples, or after N samples at the latest; the interval is that of the
+// weighted mean for weighted samples, and that of the designs for
+// stratified and Latin hypercube samples, which takes fewer samples than
+// the bound of CHB, as the designs lower the variance; for independent
+// samples it is the normal approximation of the binomial one
+class NormEstim : public Estim {
+private:
+  unsigned long int N;		// samples at most
+
+  static const unsigned long int MINSAT = 10;
+
+  bool within (double n, double x, double se) const {
+    return n >= N || (x >= MINSAT && gsl_cdf_ugaussian_Pinv((1 + c) / 2) * se <= delta);
+  }
+
+  void finish (unsigned long int n, unsigned long int x, double p, double se) {
+    if (within(n, x, se)) {
+      out = DONE;
+      samples = n;
+      successes = x;
+      estimate = p;
+      stderror = se;
+    }
+  }
+
+public:
+  NormEstim(string v) : Estim(v), N(0) {
+  }
+
+  void init() {
+    string testName;
+    double n = 0;
+
+    // convert test arguments from string to float
+    istringstream inputString(args);
+    inputString >> testName >> delta >> c >> n;
+
+    // sanity checks
+    if ((delta >= 0.5) || (delta <= 0.0)) {
+      fail(args + " : must have 0 < delta < 0.5");
+    }
+
+    if ((c <= 0.0) || (c >= 1.0)) {
+      fail(args + " : must have 0 < c < 1");
+    }
+
+    if (n < 1) {
+      fail(args + " : must have a bound of at least 1 sample");
+    }
+    N = (unsigned long int) n;
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << delta << " " << c << " " << N;
+    args = tmp.str();
+  }
+
+  unsigned long int need () const {
+    return N;
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+    double p = double (x) / double (n);
+    finish(n, x, p, sqrt(p * (1 - p) / n));
+  }
+
+  void doWeighted (unsigned long int n, unsigned long int x, Weights const & s) {
+    finish(n, x, s.wx / n, weightedError(n, s));
+  }
+
+  // the interval of the designs, at the end of one; till then the bound
+  void doDesigned (unsigned long int n, unsigned long int x, Designs const & d) {
+    double p = double (x) / double (n);
+    double se = designError(n, x, d);
+    if (se >= 0) finish(n, x, p, se);
+    else if (n >= N) finish(n, x, p, (d.error(n) >= 0) ? d.error(n) : sqrt(p * (1 - p) / n));
+  }
+
+  bool stops (double n, double x) const {
+    double p = x / n;
+    return within(n, x, sqrt(p * (1 - p) / n));
+  }
+
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const * s) const {
+    double p = (s != NULL) ? s->wx / n : double (x) / n;
+    double se = (s != NULL) ? sqrt(max(s->wx2 / n - p * p, 0.0) / n) : sqrt(p * (1 - p) / n);
+    number(os, "estimate", p);
+    number(os, "halfwidth", gsl_cdf_ugaussian_Pinv((1 + c) / 2) * se);
+    number(os, "delta", delta);
+  }
+};
+
+
+// print the results of an estimation object
+void Estim::printResult (std::ostream & os){
+
+    // platform-dependent stuff
+    string Iam = typeid(*this).name();
+
+    // print only when the test is finished
+    switch (out) {
+      case NOTDONE:
+        fail("Estim.printResult() : test not completed: " + args);
+      case DONE:
+        os << args << ": estimate = " << estimate <<  ", successes = " << successes
+                << ", samples = " << samples;
+        if (stderror >= 0) os << ", std. error = " << stderror;
+        if (timeouts > 0) os << ", timeouts = " << timeouts;
+
+        // if called by a CHB object, print the sample size
+        // of the Chernoff-Hoeffding bound, as well
+        if (Iam.find("CHB",0) != string::npos) {
+          if (CHB * ptr = dynamic_cast<CHB*>(this)) {
+            os << ", C-H bound = " << ptr->get_CH_bound();
+          } else {
+            cerr << "dynamic_cast<CHB*> failed." << endl;
+            abort();
+          }
+        }
+        if (RelEstim * ptr = dynamic_cast<RelEstim*>(this)) {
+          os << ", relative error = " << ptr->getRelative();
+        }
+        os << endl; break;
+    }
+};
+
+
+// Bayesian Interval Estimation with Beta prior
+//
+// Zuliani, Platzer, Clarke. HSCC 2010.
+//
+//
+class BayesEstim : public Estim {
+private:
+  double alpha, beta;		// Beta prior parameters
+
+public:
+  BayesEstim(string v): Estim(v), alpha(0.0), beta(0.0) {
+  }
+
+  void init() {
+    string testName;
+
+    // convert test arguments from string to float
+    istringstream inputString(args);
+    inputString >> testName >> delta >> c >> alpha >> beta;	// by default >> skips whitespaces
+
+    // sanity checks
+    if ((delta > 0.5) || (delta <= 0.0)) {
+      fail(args + " : must have 0 < delta < 0.5");
+    }
+
+    if (c <= 0.0) {
+      fail(args + " : must have c > 0");
+    }
+
+    if ((alpha <= 0.0) || (beta <= 0.0)) {
+      fail(args + " : must have alpha, beta > 0");
+    }
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << delta << " " << c << " " << alpha << " " << beta;
+    args = tmp.str();
+  }
+
+  // the posterior probability of the interval [t0, t1] around the
+  // posterior mean after n samples, x of them sat
+  double coverage (double n, double x, double & postmean, double & t0, double & t1) const {
+
+    double a, b;
+
+    // compute posterior mean
+    a = x + alpha; b = n + alpha + beta;
+    postmean = a / b;
+
+    // compute the boundaries of the interval
+    t0 = postmean - delta; t1 = postmean + delta;
+    if (t1 > 1) { t1 = 1; t0 = 1 - 2*delta;};
+    if (t0 < 0) { t1 = 2*delta; t0 = 0;};
+
+    // compute posterior probability of the interval
+    return gsl_cdf_beta_P (t1, a, b - a) - gsl_cdf_beta_P (t0, a, b - a);
+  }
+
+  // the posterior after n samples, x of them sat; true when it puts
+  // at least c on the interval around its mean, which is the estimate
+  bool covered (double n, double x) {
+
+    double t0, t1;		// interval bounds
+    double postmean;		// posterior mean
+
+    // check if done
+    if (coverage(n, x, postmean, t0, t1) >= c) {
+      estimate = postmean;
+      return true;
+    }
+    return false;
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+
+    if (covered(double(n), double(x))) {
+      out = DONE;
+      samples = n;
+      successes = x;
+    }
+  }
+
+  // weighted samples count as many as their effective sample size (Kish),
+  // with the importance sampling estimate as the fraction of sat ones
+  void doWeighted (unsigned long int n, unsigned long int x, Weights const & s) {
+
+    if (s.w2 <= 0) return;
+    double neff = s.w * s.w / s.w2;
+    double p = min(s.wx / n, 1.0);
+    if (covered(neff, p * neff)) {
+      out = DONE;
+      samples = n;
+      successes = x;
+      stderror = weightedError(n, s);
+    }
+  }
+
+  // stratified or Latin hypercube samples count as many as the independent
+  // ones that would give the sat fraction the variance of the designs, at
+  // the end of a design
+  void doDesigned (unsigned long int n, unsigned long int x, Designs const & d) {
+
+    double se = designError(n, x, d);
+    if (se < 0) return;
+    double p = double (x) / n;
+    double neff = (se > 0) ? p * (1 - p) / (se * se) : n;
+    if (covered(neff, p * neff)) {
+      out = DONE;
+      samples = n;
+      successes = x;
+      stderror = se;
+    }
+  }
+
+  bool stops (double n, double x) const {
+    double postmean, t0, t1;
+    return coverage(n, x, postmean, t0, t1) >= c;
+  }
+
+  // weighted samples by their effective sample size, as above
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const * s) const {
+    double neff = n, p = double (x) / n;
+    if (s != NULL) {
+      neff = (s->w2 > 0) ? s->w * s->w / s->w2 : 0;
+      p = min(s->wx / n, 1.0);
+    }
+    double postmean, t0, t1;
+    double cov = coverage(neff, p * neff, postmean, t0, t1);
+    number(os, "estimate", postmean);
+    number(os, "from", t0);
+    number(os, "to", t1);
+    number(os, "coverage", cov);
+    number(os, "c", c);
+  }
+};
+
+
+
+//  Lai's test
+//
+//  Tze Leung Lai
+//  "Nearly Optimal Sequential Tests of Composite Hypotheses"
+//  The Annals of Statistics
+//  1988, 16(2): 856-886
+//
+//
+//  Inputs
+//  theta: probability threshold - must satisfy 0 < theta < 1
+//  c    : cost per observation
+//  n    : number of samples
+//  x    : number of successful samples. It must be  x <= n
+//
+//
+//  The Null hypothesis H_0 is the interval [theta, 1]
+//
+//  Output
+//  out : NOTDONE more samples needed
+//        ALTHYP is the hypothesis [0, theta]
+//        NULLHYP is the hypothesis [theta, 1]
+//
+//
+
+class Lai : public HTest {
+private:
+  double cpo;                     // cost per observation
+
+  unsigned long seed;             // of the pseudo-random number generator
+  gsl_rng * r;
+  double pi;                      // 3.14159
+
+public:
+  Lai (string v, unsigned long s) : HTest(v), cpo(0.0), seed(s), r(NULL), pi(0.0) {
+  }
+
+  ~Lai () {
+    if (r != NULL) gsl_rng_free(r);
+  }
+
+  void init () {
+    string testName;
+
+    // convert test arguments from string to float
+    istringstream inputString(args);
+    inputString >> testName >> theta >> cpo;			// by default >> skips whitespaces
+
+    // sanity checks
+    if ((theta >= 1.0) || (theta <= 0.0)) {
+      fail(args + " : must have 0 < theta < 1");
+    }
+
+    if (cpo <= 0.0) {
+      fail(args + " : must have cost > 0");
+    }
+
+    // initialize pseudo-random number generator from the master seed
+    r = gsl_rng_alloc (gsl_rng_mt19937);
+    gsl_rng_set (r, seed);
+
+    pi = atan(1)*4;
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << theta << " " << cpo;
+    args = tmp.str();
+  }
+
+  // the Kullback-Leibler information number KL of the max likelihood
+  // estimate after n samples, x of them sat, and the threshold T of it
+  void information (double n, double x, double & KL, double & T) const {
+
+    double maxle = x/n;			// max likelihood estimate
+    double t;
+    double g, w = 0.0;
+
+    // compute the Kullback-Leibler information number
+    if (maxle == 0.0)
+      KL = log(1/(1-theta));
+    else if (maxle == 1.0)
+      KL = log(1/theta);
+    else
+      KL = maxle * log(maxle/theta) + (1 - maxle) * log( (1-maxle)/(1-theta) );
+
+    // compute function g and the threshold
+    t = cpo*n;
+    if (t >= 0.8) {
+        w = 1/t;
+        g = (1/(16*pi))*(pow(w,2) - (10/(48*pi))*pow(w,4) + pow(5/(48*pi), 2)*pow(w,6));
+    } else if ((0.1 <= t) && (t < 0.8))
+        g = (exp(-1.38*t-2))/(2*t);
+    else if ((0.01 <= t) && (t < 0.1))
+        g = (0.1521 + 0.000225/t - 0.00585/sqrt(t))/(2*t);
+    else {
+        w = 1/t;
+        g = 0.5*(2*log(w) + log(log(w)) - log(4*pi) - 3*exp(-0.016*sqrt(w)));
+    }
+
+    T = g/n;
+  }
+
+  bool stops (double n, double x) const {
+    double KL, T;
+    information(n, x, KL, T);
+    return KL >= T;
+  }
+
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const *) const {
+    double KL, T;
+    information(n, x, KL, T);
+    number(os, "kl", KL);
+    number(os, "threshold", T);
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+
+    double maxle = double(x)/n;		// max likelihood estimate
+    double T;
+    double KL;				// Kullback-Leibler information number
+
+    information(n, x, KL, T);
+
+    // check if we are done
+    if (KL >= T) {
+      samples = n;
+      successes = x;
+
+      // decide which hypothesis to accept
+      if (maxle == theta)
+          if (gsl_rng_uniform (r) <= 0.5) out = NULLHYP;
+          else out = ALTHYP;
+      else if (maxle > theta) out = NULLHYP; else out = ALTHYP;
+    }
+  }
+};
+
+
+// The Bayes Factor Test with Beta prior
+//
+//  It computes the Bayes Factor P(data|H_0)/P(data|H_1) and returns
+//  whether it is greater/smaller than a specified threshold value or not.
+//
+//  Inputs
+//  theta: probability threshold - must satisfy 0 < theta < 1
+//  T    : ratio threshold satisfying T > 1
+//  n    : number of samples
+//  x    : number of successful samples. It must be  x <= n
+//  alpha: Beta prior parameter
+//  beta : Beta prior parameter
+//  podds: prior odds ratio ( = P(H_1)/P(H_0) )
+//
+//  The Null hypothesis H_0 is the interval [theta, 1]
+//
+//  Output
+//  out : NOTDONE more samples needed
+//        ALTHYP is the hypothesis [0, theta]
+//        NULLHYP is the hypothesis [theta, 1]
+//
+
+class BFT : public HTest {
+private:
+  double T;			// ratio threshold
+  double podds;			// prior odds
+  double alpha, beta;		// Beta prior parameters
+
+public:
+  BFT (string v) : HTest(v), T(0.0), podds(0.0), alpha(0.0), beta(0.0) {
+  }
+
+  void init () {	// initialize test parameters
+
+    double p0, p1;		// prior probabilities
+    string testName;
+
+    // convert test arguments from string to double
+    istringstream inputString(args);
+    inputString >> testName >> theta >> T >> alpha >> beta;		// by default >> skips whitespaces
+
+    // sanity checks
+    if (T <= 1.0) {
+      fail(args + " : must have T > 1");
+    }
+
+    if ((theta >= 1.0) || (theta <= 0.0)) {
+      fail(args + " : must have 0 < theta < 1");
+    }
+
+    if ((alpha <= 0.0) || (beta <= 0.0)) {
+      fail(args + " : must have alpha, beta > 0");
+    }
+
+    // compute prior probability of the alternative hypothesis
+    p1 = gsl_cdf_beta_P (theta, alpha, beta);
+
+    // sanity check
+    if ((p1 >= 1.0) || (p1 <= 0.0)) {
+      fail(args + " : Prob(H_1) is either 0 or 1");
+    }
+    p0 = 1 - p1;
+
+    // compute prior odds
+    podds = p1 / p0;
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << theta << " " << T << " " << alpha << " " << beta;
+    args = tmp.str();
+  }
+
+
+  // the Bayes Factor after n samples, x of them sat
+  double factor (double n, double x) const {
+    return podds * (1/gsl_cdf_beta_P(theta, x+alpha, n-x+beta) - 1);
+  }
+
+  bool stops (double n, double x) const {
+    double B = factor(n, x);
+    return B > T || B < 1/T;
+  }
+
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const *) const {
+    number(os, "bayes_factor", factor(n, x));
+    number(os, "threshold", T);
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+
+    double B;
+
+    // compute Bayes Factor
+    B = factor(n, x);
+
+    // compare and, if done, set
+    if (B > T) {out = NULLHYP; samples = n; successes = x;}
+    else if (B < 1/T) {out = ALTHYP; samples = n; successes = x;}
+
+  }
+};
+
+
+// The Bayes Factor Test with Beta prior and indifference region
+//
+// It computes the Bayes Factor P(data|H_0)/P(data|H_1) and returns
+// whether it is greater/smaller than a specified threshold value or not.
+//
+//  Inputs
+//  theta1: probability threshold - must satisfy 0 < theta1 < theta2 < 1
+//  theta2: probability threshold
+//  T    : ratio threshold satisfying T > 1
+//  n    : number of samples
+//  x    : number of successful samples. It must be  x <= n
+//  alpha: Beta prior parameter
+//  beta : Beta prior parameter
+//  podds: prior odds ratio ( = P(H_1)/P(H_0) )
+//
+//  The Null hypothesis H_0 is the interval [theta2, 1]
+//
+//  Output
+//  out : NOTDONE more samples needed
+//        ALTHYP is the hypothesis [0, theta1]
+//        NULLHYP is the hypothesis [theta2, 1]
+//
+//
+
+class BFTI : public HTest {
+private:
+  double T;			// ratio threshold
+  double podds;			// prior odds
+  double alpha, beta;		// Beta prior parameters
+  double delta;			// half indifference region
+  double theta1, theta2;	// theta1 < theta2 (indifference region)
+
+public:
+  BFTI (string v) : HTest(v), T(0.0), podds(0.0), alpha(0.0), beta(0.0), delta(0.0), theta1(0.0), theta2(0.0) {
+  }
+
+  void init () {		// initialize test parameters
+
+    double p0, p1;		// prior probabilities
+    string testName;
+
+    // convert test arguments from string to float
+    istringstream inputString(args);
+    inputString >> testName >> theta >> T >> alpha >> beta >> delta;	// by default >> skips whitespaces
+
+    // sanity checks
+    if (T <= 1.0) {
+      fail(args + " : must have T > 1");
+    }
+
+    if ((theta >= 1.0) || (theta <= 0.0)) {
+      fail(args + " : must have 0 < theta < 1");
+    }
+
+    if ((alpha <= 0.0) || (beta <= 0.0)) {
+      fail(args + " : must have alpha, beta > 0");
+    }
+
+    if ((delta >= 0.5) || (delta <= 0.0)) {
+      fail(args + " : must have 0 < delta < 0.5");
+    }
+
+    // prepare parameters
+    theta1 = max(0.0, theta-delta);
+    theta2 = min(1.0, theta+delta);
+
+    // another sanity check
+    if ((theta1 <= 0.0) || (theta2 >= 1.0)) {
+      fail(args + " : indifference region borders 0 or 1");
+    }
+
+    // compute prior probability of the alternative hypothesis
+    p1 = gsl_cdf_beta_P (theta1, alpha, beta);
+
+    // sanity check
+    if ((p1 >= 1.0) || (p1 <= 0.0)) {
+      fail(args + " : Prob(H_1) is either 0 or 1");
+    }
+    p0 = 1 - p1;
+
+    // compute prior odds
+    podds = p1 / p0;
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << theta << " " << T << " " << alpha << " " << beta << " " << delta;
+    args = tmp.str();
+  }
+
+
+  // the Bayes Factor after n samples, x of them sat
+  double factor (double n, double x) const {
+    return podds * (1 - gsl_cdf_beta_P(theta2, x+alpha, n-x+beta)) / gsl_cdf_beta_P(theta1, x+alpha, n-x+beta);
+  }
+
+  bool stops (double n, double x) const {
+    double B = factor(n, x);
+    return B > T || B < 1/T;
+  }
+
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const *) const {
+    number(os, "bayes_factor", factor(n, x));
+    number(os, "threshold", T);
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+
+    double B;
+
+    // compute Bayes Factor
+    B = factor(n, x);
+
+    // compare and, if done, set
+    if (B > T) {out = NULLHYP; samples = n; successes = x;}
+    else if (B < 1/T) {out = ALTHYP; samples = n; successes = x;}
+
+  }
+  bool correct (double p) const {
+    return ((p > theta1) && (p < theta2)) || HTest::correct(p);
+  }
+};
+
+
+
+// The Sequential Probability Ratio Test
+//
+//  Inputs
+//  theta1, theta2 : probability thresholds satisfying theta1 < theta2
+//  T : ratio threshold satisfying T > 1
+//  n : number of samples
+//  x : number of successful samples. It must be  x <= n
+//
+//  Output
+//  out : NOTDONE more samples needed
+//        ALTHYP is the hypothesis [0, theta1]
+//        NULLHYP is the hypothesis [theta2, 1]
+
+class SPRT : public HTest {
+private:
+  double delta;			// half indifference region
+  double theta1, theta2;	// theta1 < theta2 (indifference region)
+  double T;			// ratio threshold
+  double up, down;		// the log-ratio of a sat and of an unsat sample
+  double t;			// the log-threshold
+
+public:
+  SPRT (string v) : HTest(v), delta(0.0), theta1(0.0), theta2(0.0), T(0.0), up(0.0), down(0.0), t(0.0) {
+  }
+
+  void init () {		// initialize test parameters
+
+    string testName;
+
+    // convert test arguments from string to float
+    istringstream inputString(args);
+    inputString >> testName >> theta >> T >> delta;		// by default >> skips whitespaces
+
+    // sanity checks
+    if (T <= 1.0) {
+      fail(args + " : must have T > 1");
+    }
+
+    if ((theta >= 1.0) || (theta <= 0.0)) {
+      fail(args + " : must have 0 < theta < 1");
+    }
+
+    if ((delta >= 0.5) || (delta <= 0.0)) {
+      fail(args + " : must have 0 < delta < 0.5");
+    }
+
+    // prepare parameters
+    theta1 = max(0.0, theta-delta);
+    theta2 = min(1.0, theta+delta);
+
+    // another sanity check
+    if ((theta1 <= 0.0) || (theta2 >= 1.0)) {
+      fail(args + " : indifference region borders 0 or 1");
+    }
+
+    // once, rather than on every sample of every threshold of a grid
+    up = log (theta2/theta1);
+    down = log((1-theta2)/(1-theta1));
+    t = log(T);
+
+    // writes back the test arguments, with proper formatting
+    ostringstream tmp;
+    tmp << testName << " " << theta << " " << T << " " << delta;
+    args = tmp.str();
+  }
+
+  void doTest (unsigned long int n, unsigned long int x) {
+
+    // compute log-ratio
+    double r = x * up + (n-x) * down;
+
+    // compare and, if done, set
+    if (r > t) {out = NULLHYP; samples = n; successes = x;}
+    else { if (r < -t) {out = ALTHYP; samples = n; successes = x;}}
+  }
+
+  bool stops (double n, double x) const {
+    double r = x * up + (n-x) * down;
+    return r > t || r < -t;
+  }
+
+  void statistic (std::ostream & os, unsigned long int n, unsigned long int x, Weights const *) const {
+    number(os, "log_ratio", x * up + (n-x) * down);
+    number(os, "threshold", t);
+  }
+
+  bool correct (double p) const {
+    return ((p > theta1) && (p < theta2)) || HTest::correct(p);
+  }
+};
+
+
+
+// the number of samples the tests not done yet can use
+unsigned long int needed (vector<Test *> & tests) {
+    unsigned long int n = 0;
+    for (unsigned int j = 0; j < tests.size(); j++) {
+        if (!tests[j]->done()) n = max(n, tests[j]->need());
+    }
+    return n;
+}
+
+// the samples to look ahead at most for a test to be done
+static const unsigned long int HORIZON = 1UL << 40;
+
+unsigned long int Test::remaining (unsigned long int n, unsigned long int x, bool bounded) const {
+
+    if (done()) return 0;
+    unsigned long int most = need();
+    if (most != ULONG_MAX) most = (most > n) ? most - n : 0;
+    if (bounded || n == 0) return most;
+
+    // the first m more samples that stop it, by doubling m, then halving
+    // the range; the tests stop once and for all on their way, mostly
+    double p = double (x) / n;
+    unsigned long int bound = min(most, HORIZON);
+    unsigned long int lo = 0, hi = 1;
+    while (hi < bound && !stops(n + double (hi), x + p * hi)) {
+        lo = hi;
+        hi *= 2;
+    }
+    if (hi >= bound) {
+        if (!stops(n + double (bound), x + p * bound)) return most;
+        hi = bound;
+    }
+    while (hi - lo > 1) {
+        unsigned long int mid = lo + (hi - lo) / 2;
+        if (stops(n + double (mid), x + p * mid)) hi = mid;
+        else lo = mid;
+    }
+    return hi;
+}
+
+void Test::progress (std::ostream & os, unsigned long int n, unsigned long int x, Weights const * s, bool bounded) const {
+
+    os << "\"test\": \"" << args << "\", \"done\": " << (done() ? "true" : "false");
+    if (done()) {
+        os << ", \"samples\": " << samples << ", \"successes\": " << successes;
+        return;
+    }
+    if (n > 0) statistic(os, n, x, s);
+    unsigned long int left = remaining(n, x, bounded);
+    os << ", \"remaining\": ";
+    if (left == ULONG_MAX) os << "null";
+    else os << left;
+}
+
+Test * make_test (string const & line, unsigned long seed) {
+
+    istringstream iline(line);		// each line is a test specification
+    string keyword;
+    Test * test;
+
+    // by default, extraction >> skips whitespaces
+    iline >> keyword;
+
+    // discard comments (lines starting with '#') or empty lines
+    if ((keyword.compare(0, 1, "#") == 0) || (keyword.length() == 0)) return NULL;
+
+    transform(keyword.begin(), keyword.end(), keyword.begin(), ::toupper);  // convert to uppercase
+
+    // create the corresponding object
+    if      (keyword == "SPRT") test = new SPRT(line);
+    else if (keyword == "BFT")  test = new BFT(line);
+    else if (keyword == "LAI")  test = new Lai(line, seed);
+    else if (keyword == "CHB")  test = new CHB(line);
+    else if (keyword == "BEST") test = new BayesEstim(line);
+    else if (keyword == "BFTI") test = new BFTI(line);
+    else if (keyword == "NSAM") test = new NSAM(line);
+    else if (keyword == "REL")  test = new RelEstim(line);
+    else if (keyword == "NORM") test = new NormEstim(line);
+    else {
+        fail("Test unknown: " + line);
+    }
+
+    try {
+        test->init();				// initializes the object
+    } catch (...) {
+        delete test;
+        throw;
+    }
+    return test;
+}
+
+// the lines of the tests of a specification: one, or one per threshold
+// when the theta of a hypothesis test is the grid <from>:<to>:<step>
+static vector<string> expand (string const & line) {
+
+    istringstream iline(line);
+    vector<string> words;
+    string w;
+    while (iline >> w) words.push_back(w);
+    if (words.size() < 2 || words[0][0] == '#' || words[1].find(':') == string::npos) return vector<string>(1, line);
+
+    string keyword = words[0];
+    transform(keyword.begin(), keyword.end(), keyword.begin(), ::toupper);
+    if (keyword != "SPRT" && keyword != "BFT" && keyword != "BFTI" && keyword != "LAI") {
+        fail("a grid is only for the theta of a hypothesis test: " + line);
+    }
+    double from, to, step;
+    char colon1, colon2;
+    istringstream grid(words[1]);
+    if (!(grid >> from >> colon1 >> to >> colon2 >> step) || colon1 != ':' || colon2 != ':'
+        || !grid.eof() || !(step > 0) || from > to) {
+        fail("the grid of theta must be <from>:<to>:<step>: " + line);
+    }
+
+    // by index, so that no rounding error piles up along the grid
+    vector<string> lines;
+    for (unsigned long i = 0; from + i * step <= to + step * 1e-9; ++i) {
+        ostringstream spec;
+        spec << words[0] << " " << from + i * step;
+        for (size_t k = 2; k < words.size(); ++k) spec << " " << words[k];
+        lines.push_back(spec.str());
+    }
+    return lines;
+}
+
+vector<Test *> make_tests (string const & line, vector<string> * specs, unsigned long seed) {
+
+    vector<Test *> tests;
+    vector<string> lines = expand(line);
+    try {
+        for (size_t i = 0; i < lines.size(); ++i) {
+            Test * test = make_test(lines[i], seed);
+            if (test == NULL) continue;
+            tests.push_back(test);
+            if (specs != NULL) specs->push_back(lines[i]);
+        }
+    } catch (...) {
+        for (size_t j = 0; j < tests.size(); ++j) delete tests[j];
+        throw;
+    }
+    return tests;
+}
+
+vector<Test *> read_tests (string const & testfile, vector<string> * specs, unsigned long seed) {
+
+    vector<Test *> tests;
+    string line;
+
+    // read test input file line by line
+    ifstream input(testfile.c_str());
+    if (!input.is_open()) {
+        fail("cannot open testfile: " + testfile);
+    }
+
+    // for each test create object, pass arguments, and initialize
+    try {
+        while (getline(input, line)) {
+            vector<Test *> more = make_tests(line, specs, seed);
+            tests.insert(tests.end(), more.begin(), more.end());
+        }
+    } catch (...) {
+        for (size_t j = 0; j < tests.size(); ++j) delete tests[j];
+        throw;
+    }
+    return tests;
+}
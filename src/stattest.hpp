@@ -0,0 +1,256 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+#include "sampler.hpp"
+#include "util.hpp"
+
+// base class for every statistical test
+class Test {
+protected:
+
+  std::string args;
+  unsigned int out;			// current result of the test
+  unsigned long int samples, successes;	// number of samples, successes
+  unsigned long int timeouts;		// dReach runs over the limits for the samples
+
+public:
+
+  static const unsigned int NOTDONE = 0;
+  static const unsigned int DONE = 1;
+
+  // no default constructor
+  Test(std::string v) : args(v), out(NOTDONE), samples(0), successes(0), timeouts(0) {
+  }
+
+  virtual ~Test () {
+  }
+
+  void setTimeouts (unsigned long int t) {
+    timeouts = t;
+  }
+
+  virtual void init () =0;
+
+  bool done () const {
+    return (out != NOTDONE);
+  }
+
+  // the result, and the samples it took, once done
+  unsigned int getResult () const {
+    return out;
+  }
+
+  unsigned long int getSamples () const {
+    return samples;
+  }
+
+  std::string const & getArgs () const {
+    return args;
+  }
+
+  virtual void doTest(unsigned long int n, unsigned long int x) = 0;
+
+  virtual void printResult (std::ostream & os) = 0;
+
+  // importance sampling: n samples, x of them sat, and the sums of their
+  // likelihood ratios; only estimators can use weighted samples
+  virtual void doWeighted (unsigned long int, unsigned long int, Weights const &) {
+    fail(args + " : cannot use weighted samples");
+  }
+
+  // stratified or Latin hypercube samples: n samples, x of them sat, and
+  // the sums of their designs; the sat fraction stays unbiased, the
+  // estimators that stop on its variance take that of the designs
+  virtual void doDesigned (unsigned long int n, unsigned long int x, Designs const &) {
+    doTest(n, x);
+  }
+
+  // done at once from the exact probability p, worked out from n
+  // samples of which x were sat
+  virtual void decide (double p, unsigned long int n, unsigned long int x) = 0;
+
+  // the number of samples by which the test is surely done,
+  // ULONG_MAX when only the samples themselves can tell
+  virtual unsigned long int need () const {
+    return ULONG_MAX;
+  }
+
+  // whether the test would be done after n samples, x of them sat,
+  // which may be fractions; false when it cannot tell
+  virtual bool stops (double, double) const {
+    return false;
+  }
+
+  // the fields of the statistic the test stops on, after n samples, x of
+  // them sat, each as ", \"name\": value" of a JSON object; s are the
+  // likelihood ratios for weighted samples, else NULL
+  virtual void statistic (std::ostream &, unsigned long int, unsigned long int, Weights const *) const {
+  }
+
+  // the samples left until the test is done, if the fraction of sat ones
+  // stays x / n, ULONG_MAX when there is no telling; weighted samples and
+  // those of designs (bounded) only get the bound of need()
+  unsigned long int remaining (unsigned long int n, unsigned long int x, bool bounded) const;
+
+  // the state of the test as the fields of a JSON object, for the
+  // progress of a run
+  void progress (std::ostream & os, unsigned long int n, unsigned long int x, Weights const * s, bool bounded) const;
+
+};
+
+// base class for hypothesis tests
+class HTest : public Test {
+protected:
+  double theta;			// threshold
+                                // Null hypothesis is (theta, 1)
+
+public:
+
+  static const unsigned int NULLHYP = 2;
+  static const unsigned int ALTHYP  = 1;
+
+  HTest(std::string v): Test(v), theta(0.0) {
+  }
+
+  // whether the result is right when the probability is p; either
+  // answer is right at the threshold and, for the tests with one,
+  // inside the indifference region
+  virtual bool correct (double p) const {
+    if (p == theta) return true;
+    return (out == NULLHYP) == (p > theta);
+  }
+
+  void decide (double p, unsigned long int n, unsigned long int x) {
+    out = (p > theta) ? NULLHYP : ALTHYP;
+    samples = n;
+    successes = x;
+  }
+
+  void printResult (std::ostream & os) {
+
+    switch (out) {
+      // print only when the test is finished
+      case NOTDONE:
+        fail("Test.printResult() : test not completed: " + args);
+      case NULLHYP:
+        os << args << ": " << "Accept Null hypothesis"; break;
+      case ALTHYP:
+        os << args << ": " << "Reject Null hypothesis"; break;
+    }
+    os << ", successes = " << successes << ", samples = " << samples;
+    if (timeouts > 0) os << ", timeouts = " << timeouts;
+    os << std::endl;
+  }
+};
+
+
+// base class for statistical estimation
+class Estim : public Test {
+protected:
+  double delta;			// half-interval width
+  double c;			// coverage probability
+  double estimate;		// the estimate
+  double stderror;		// its standard error, for weighted samples
+
+  // the standard error of the importance sampling estimate
+  double weightedError (unsigned long int n, Weights const & s) {
+    double mean = s.wx / n;
+    return sqrt(std::max(s.wx2 / n - mean * mean, 0.0) / n);
+  }
+
+  // the standard error of the sat fraction of stratified or Latin hypercube
+  // samples, at the end of a design, from the variance of the designs; -1
+  // while it cannot be told, that of independent samples when it is 0,
+  // which few designs alike do not show
+  double designError (unsigned long int n, unsigned long int x, Designs const & d) {
+    double se = d.error(n);
+    if (!d.whole() || se < 0) return -1;
+    double p = double (x) / n;
+    return (se > 0) ? se : sqrt(p * (1 - p) / n);
+  }
+
+public:
+
+  Estim(std::string v) : Test(v), delta(0.0), c(0.0), estimate(0.0), stderror(-1.0){
+  }
+
+  void decide (double p, unsigned long int n, unsigned long int x) {
+    estimate = p;
+    stderror = 0;
+    samples = n;
+    successes = x;
+    out = DONE;
+  }
+
+  double getEstimate () const {
+    return estimate;
+  }
+
+  // the half-interval width asked for, 0 for a fixed number of samples
+  double getDelta () const {
+    return delta;
+  }
+
+  // the same around the probability p
+  virtual double halfwidth (double) const {
+    return delta;
+  }
+
+  // defined later because it uses a method from class CHB
+  void printResult (std::ostream & os);
+
+};
+
+
+// the test of a line of a test file (SPRT, BFT, BFTI, LAI, CHB, BEST,
+// NSAM, REL or NORM, and its arguments), initialized; NULL for comments and empty lines;
+// the master seed of the run seeds the coin Lai's test tosses at a tie
+Test * make_test (std::string const & line, unsigned long seed = 0);
+
+// the tests of a line of a test file: none, one, or one per threshold of a grid
+std::vector<Test *> make_tests (std::string const & line, std::vector<std::string> * specs = NULL,
+                                unsigned long seed = 0);
+
+// the tests of a test file, in order, with the lines that specify them;
+// a hypothesis test whose theta is the grid <from>:<to>:<step> gives one
+// test per threshold, all run on the same samples
+std::vector<Test *> read_tests (std::string const & testfile, std::vector<std::string> * specs = NULL,
+                                unsigned long seed = 0);
+
+// the number of samples the tests not done yet can use
+unsigned long int needed (std::vector<Test *> & tests);
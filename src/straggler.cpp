@@ -0,0 +1,90 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+// the straggler policies of --on-timeout
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include "solver.hpp"
+#include "straggler.hpp"
+#include "util.hpp"
+
+using std::string;
+using std::ostringstream;
+using std::cerr;
+using std::endl;
+
+Straggler::Straggler (string const & name, string const & delta) : precision(delta) {
+    if      (name == "redraw")  policy = REDRAW;
+    else if (name == "sat")     policy = SAT;
+    else if (name == "unsat")   policy = UNSAT;
+    else if (name == "coarsen") policy = COARSEN;
+    else {
+        fail("--on-timeout must be redraw, sat, unsat or coarsen: " + name);
+    }
+}
+
+int Straggler::check (std::function<int (string const &)> const & solve, unsigned long & hits, bool & guessed) const {
+
+    guessed = false;
+    int res = solve("");
+    if (res != Solver::UNKNOWN) return res;
+    hits++;
+
+    switch (policy) {
+        case SAT:
+            guessed = true;
+            return Solver::SAT;
+        case UNSAT:
+            guessed = true;
+            return Solver::UNSAT;
+        case COARSEN: {
+            double delta = strtod(precision.c_str(), NULL);
+            for (int i = 0; i < COARSENINGS; ++i) {
+                delta *= 10;
+                ostringstream coarser;
+                coarser << delta;
+                res = solve(coarser.str());
+                // unsat at a coarser precision is unsat at the one asked for,
+                // delta-sat there is only a guess at it
+                if (res == Solver::SAT) guessed = true;
+                if (res != Solver::UNKNOWN) return res;
+                hits++;
+            }
+            // drawn again when even the coarsest precision is too slow
+            return Solver::UNKNOWN;
+        }
+        default:
+            return Solver::UNKNOWN;
+    }
+}
@@ -0,0 +1,62 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <string>
+#include <functional>
+
+// what is done with a sample whose dReach run hit the time or the memory
+// limit: draw it again, take it as sat or as unsat, or check it again at
+// a coarser precision, where only an unsat verdict holds for the precision
+// asked for, and a delta-sat one is taken as a guess
+class Straggler {
+public:
+    enum Policy { REDRAW, SAT, UNSAT, COARSEN };
+
+    static const int REDRAWS = 100;         // draws of one sample, at most
+    static const int COARSENINGS = 3;       // coarser precisions tried, each 10 times the last
+
+private:
+    Policy policy;
+    std::string precision;
+
+public:
+    // the policy named by --on-timeout, for runs at the given precision
+    Straggler (std::string const & name, std::string const & delta);
+
+    Policy get () const { return policy; }
+
+    // check a draw with solve(delta), an empty delta for the default one,
+    // and apply the policy when it hits the limits; return SAT or UNSAT,
+    // UNKNOWN when it is to be drawn again, or whatever else solve returned
+    // hits counts the runs over the limits, guessed is set when the verdict
+    // is the policy's rather than dReach's
+    int check (std::function<int (std::string const &)> const & solve, unsigned long & hits, bool & guessed) const;
+};
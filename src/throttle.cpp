@@ -0,0 +1,98 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+
+
+#include <algorithm>
+#include "throttle.hpp"
+
+// a period lasts at least this long, and until as many samples were checked
+// as runs may go on at once, so that slow runs are measured too
+static const double PERIOD = 2.0;
+// a change of the samples per second smaller than this is taken for noise
+static const double NOISE = 0.1;
+
+Throttle::Throttle (Resources const & r, unsigned workers, bool tune)
+    : resources(r), most(std::max(workers, 1U)), limit(most), inflight(0), low(most), high(most),
+      tuning(tune), closed(false), direction(-1), last(0), finished(0), since(Clock::now()) {
+}
+
+void Throttle::move (int by) {
+    int to = static_cast<int>(limit) + by;
+    limit = static_cast<unsigned>(std::max(1, std::min(static_cast<int>(most), to)));
+    low = std::min(low, limit);
+    high = std::max(high, limit);
+    // the new period measures the new limit
+    finished = 0;
+    since = Clock::now();
+    if (limit > inflight) waiting.notify_all();
+}
+
+bool Throttle::enter () {
+    std::unique_lock<std::mutex> guard(lock);
+    waiting.wait(guard, [this] { return closed || inflight < limit; });
+    if (closed) return false;
+    inflight++;
+    return true;
+}
+
+void Throttle::leave (unsigned long peak) {
+    std::lock_guard<std::mutex> guard(lock);
+    inflight--;
+    waiting.notify_one();
+    if (!tuning) return;
+    finished++;
+
+    // one more run of the size of the largest so far must fit, or one fewer is let in
+    unsigned long need = peak << 10;
+    unsigned long room = (need > 0) ? resources.headroom() : 0;
+    if (need > 0 && room < need && limit > 1) {
+        direction = -1;
+        last = 0;
+        move(-1);
+        return;
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - since).count();
+    if (elapsed < PERIOD || finished < limit) return;
+    double rate = finished / elapsed;
+    // slower than before the last move: back again, and on the other way
+    if (last > 0 && rate < last * (1 - NOISE)) direction = -direction;
+    last = rate;
+    // no more runs than twice the memory of the largest would hold
+    if (direction > 0 && need > 0 && room < 2 * need) direction = -1;
+    move(direction);
+}
+
+void Throttle::close () {
+    std::lock_guard<std::mutex> guard(lock);
+    closed = true;
+    waiting.notify_all();
+}
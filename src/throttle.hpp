@@ -0,0 +1,83 @@
+/***********************************************************************************************
+ * Copyright (C) 2014 Qinsi Wang and Edmund M. Clarke.  All rights reserved.
+ * By using this software the USER indicates that he or she has read, understood and will comply
+ * with the following:
+ *
+ * 1. The USER is hereby granted non-exclusive permission to use, copy and/or
+ * modify this software for internal, non-commercial, research purposes only. Any
+ * distribution, including commercial sale or license, of this software, copies of
+ * the software, its associated documentation and/or modifications of either is
+ * strictly prohibited without the prior consent of the authors. Title to copyright
+ * to this software and its associated documentation shall at all times remain with
+ * the authors. Appropriated copyright notice shall be placed on all software
+ * copies, and a complete copy of this notice shall be included in all copies of
+ * the associated documentation. No right is granted to use in advertising,
+ * publicity or otherwise any trademark, service mark, or the name of the authors.
+ *
+ * 2. This software and any associated documentation is provided "as is".
+ *
+ * THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, EXPRESSED OR IMPLIED,
+ * INCLUDING THOSE OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT
+ * USE OF THE SOFTWARE, MODIFICATIONS, OR ASSOCIATED DOCUMENTATION WILL NOT
+ * INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS OR OTHER INTELLECTUAL PROPERTY
+ * RIGHTS OF A THIRD PARTY.
+ *
+ * The authors shall not be liable under any circumstances for any direct,
+ * indirect, special, incidental, or consequential damages with respect to any
+ * claim by USER or any third party on account of or arising from the use, or
+ * inability to use, this software or its associated documentation, even if the
+ * authors have been advised of the possibility of those damages.
+ * ***********************************************************************************************/
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include "resources.hpp"
+
+// how many local dReach runs go on at once: at most one per worker, fewer
+// while the memory left would not hold one more run, and, tuned, the number
+// that checked the most samples per second so far: each period it moves one
+// run up or down, and turns back when that made the samples slower
+// a worker enters before it takes a sample, and leaves once it is checked
+class Throttle {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Resources const & resources;
+    unsigned most;                      // the workers
+    unsigned limit;                     // runs at once
+    unsigned inflight;
+    unsigned low, high;                 // the least and the most runs at once of the run so far
+    bool tuning;
+    bool closed;
+    int direction;                      // of the last move, +1 or -1
+    double last;                        // samples per second of the period before, 0 for none
+    unsigned long finished;             // samples checked in this period
+    Clock::time_point since;            // the start of the period
+    std::mutex lock;
+    std::condition_variable waiting;
+
+    void move (int by);
+
+public:
+    Throttle (Resources const & r, unsigned workers, bool tune);
+
+    // wait until one more run may start, false once closed
+    bool enter ();
+
+    // a worker is done with its sample, after runs of at most peak kB each
+    void leave (unsigned long peak);
+
+    // let every waiting worker go, the run is over
+    void close ();
+
+    unsigned current () const {
+        return limit;
+    }
+    unsigned lowest () const {
+        return low;
+    }
+    unsigned highest () const {
+        return high;
+    }
+};